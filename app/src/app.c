@@ -7,11 +7,18 @@
 #include <zephyr/logging/log.h>
 #include <zephyr/sys/util.h>
 
+#include "app/bus.h"
+#include "app/lvmem.h"
 #include "app/model.h"
 #include "app/modes.h"
 #include "app/screen.h"
+#include "app/screens/noti_list_screen.h"
 #include "app/screens/noti_screen.h"
+#include "app/screens/stopwatch_screen.h"
 #include "app/screens/watchface_screen.h"
+#include "app/snapshot.h"
+#include "app/toast.h"
+#include "diag.h"
 #include "display/lv_display.h"
 #include "driver/LPM013M126A.h"
 #include "hal/ancs_client.h"
@@ -24,7 +31,9 @@ LOG_MODULE_REGISTER(ui_module, LOG_LEVEL_DBG);
 #define UI_LCD_WIDTH LCD_DEVICE_WIDTH
 #define UI_LCD_HEIGHT LCD_DEVICE_HEIGHT
 
-#define UI_DRAW_BUF_PIXELS (UI_LCD_WIDTH * UI_LCD_HEIGHT)
+// Partial rendering: LVGL only redraws invalidated areas, in bands of this many lines
+#define UI_DRAW_BUF_LINES LCD_DISP_HEIGHT_MAX_BUF
+#define UI_DRAW_BUF_PIXELS (UI_LCD_WIDTH * UI_DRAW_BUF_LINES)
 #define UI_DRAW_BUF_BYTES (UI_DRAW_BUF_PIXELS * LV_COLOR_FORMAT_GET_SIZE(LV_COLOR_FORMAT_RGB565))
 
 static uint8_t draw_buf_mem[UI_DRAW_BUF_BYTES] __aligned(16);
@@ -32,6 +41,76 @@ static uint8_t draw_buf_mem[UI_DRAW_BUF_BYTES] __aligned(16);
 static lv_display_t* disp;
 static screen_t* current_screen = NULL;
 
+static void screen_handle_event(app_event_t* event) { current_screen->handle_event(event); }
+
+/* Forwards to the current screen, with its event_mask */
+static bus_subscriber_t screen_subscriber = {
+    .name = "screen",
+    .handle_event = screen_handle_event,
+};
+
+static void clock_handle_event(app_event_t* event) {
+  if (event->ptr && rtc_time_set((const struct rtc_time*)event->ptr) < 0) {
+    LOG_ERR("Failed to apply CTS time");
+  }
+}
+
+static bus_subscriber_t clock_subscriber = {
+    .name = "clock",
+    .event_mask = BUS_ON(APP_EVENT_BLE_CTS),
+    .handle_event = clock_handle_event,
+};
+
+static void toast_handle_event(app_event_t* event) {
+  const ancs_noti_info_t* info = event->ptr;
+
+  if (event->type == APP_EVENT_BUTTON) {
+    toast_dismiss();
+  } else if (event->type == APP_EVENT_BLE_ANCS_IDLE) {
+    toast_burst_end();
+  } else if (model_last_change()->added && model_last_change()->removed < 0 &&
+             !(info->flags & (ANCS_NOTI_SILENT | ANCS_NOTI_PRE_EXISTING)) && current_screen != &noti_screen &&
+             current_screen != &noti_list_screen) {
+    // New notifications only, not the backlog synced on connection; the notification screens show them already
+    toast_notify();
+  }
+}
+
+static bus_subscriber_t toast_subscriber = {
+    .name = "toast",
+    .event_mask = BUS_ON(APP_EVENT_BUTTON) | BUS_ON(APP_EVENT_BLE_ANCS) | BUS_ON(APP_EVENT_BLE_ANCS_IDLE),
+    .handle_event = toast_handle_event,
+};
+
+static screen_t* const screens[] = {&watchface_screen, &noti_screen, &noti_list_screen, &stopwatch_screen};
+
+/* A hidden screen misses the events it would redraw on, so its cached frame goes stale */
+static void snapshot_handle_event(app_event_t* event) {
+  for (size_t i = 0; i < ARRAY_SIZE(screens); i++) {
+    if (screens[i] != current_screen && (screens[i]->event_mask & BUS_ON(event->type))) {
+      snapshot_invalidate(screens[i]);
+    }
+  }
+}
+
+/* Follows the event masks of the hidden screens, except input */
+static bus_subscriber_t snapshot_subscriber = {
+    .name = "snapshot",
+    .handle_event = snapshot_handle_event,
+};
+
+/*
+ * Subscribers in dispatch order: the model and mode manager update state
+ * before the toast and the current screen look at it.
+ */
+static bus_subscriber_t* const subscribers[] = {
+    &model_subscriber,    &modes_subscriber,  &clock_subscriber, &toast_subscriber,
+    &snapshot_subscriber, &screen_subscriber,
+#ifdef CONFIG_SHELL
+    &diag_subscriber,
+#endif
+};
+
 static uint8_t rgb565_to_lcd4(uint16_t rgb565) {
   uint8_t r5 = (rgb565 >> 11) & 0x1F;
   uint8_t g6 = (rgb565 >> 5) & 0x3F;
@@ -52,7 +131,10 @@ static void ui_display_flush_cb(lv_display_t* display, const lv_area_t* area, ui
     }
   }
   LOG_DBG("Flushed area x1:%d y1:%d x2:%d y2:%d", area->x1, area->y1, area->x2, area->y2);
-  cmlcd_refresh();
+  // Send the changed panel lines once all areas of this refresh are drawn
+  if (lv_display_flush_is_last(display)) {
+    cmlcd_refresh();
+  }
   lv_display_flush_ready(display);
 }
 
@@ -60,7 +142,32 @@ void app_switch_screen(screen_t* screen) {
   if (screen == NULL || screen == current_screen) {
     return;
   }
+  // Remember what the old screen looked like and show the last frame of the
+  // new one right away; LVGL's render then only changes the rows that differ.
+  // A frame with the toast over it is not the screen's, it would bring the toast back.
+  if (toast_visible()) {
+    snapshot_invalidate(current_screen);
+  } else {
+    snapshot_save(current_screen);
+  }
+  if (current_screen && current_screen->unload) {
+    current_screen->unload();
+  }
+  lvmem_log();
+  lvmem_set_owner(screen->name);
   current_screen = screen;
+  bus_set_mask(&screen_subscriber, current_screen->event_mask);
+
+  uint32_t hidden_mask = 0;
+  for (size_t i = 0; i < ARRAY_SIZE(screens); i++) {
+    if (screens[i] != current_screen) {
+      hidden_mask |= screens[i]->event_mask;
+    }
+  }
+  bus_set_mask(&snapshot_subscriber, hidden_mask & ~BUS_ON(APP_EVENT_BUTTON));
+  if (snapshot_restore(current_screen)) {
+    cmlcd_refresh();
+  }
   if (current_screen->load) {
     current_screen->load();
   }
@@ -89,17 +196,22 @@ int app_init(void) {
   lv_display_set_default(disp);
   lv_display_set_color_format(disp, LV_COLOR_FORMAT_RGB565);
   lv_display_set_flush_cb(disp, ui_display_flush_cb);
-  lv_display_set_buffers(disp, draw_buf_mem, NULL, UI_DRAW_BUF_BYTES, LV_DISPLAY_RENDER_MODE_FULL);
+  lv_display_set_buffers(disp, draw_buf_mem, NULL, UI_DRAW_BUF_BYTES, LV_DISPLAY_RENDER_MODE_PARTIAL);
 
   ui_init();
+  toast_init();
   LOG_INF("UI init done");
 
-  // Initialize screens
-  watchface_screen.init();
-  noti_screen.init();
+  // Initialize screens, charging their LVGL objects to them
+  for (size_t i = 0; i < ARRAY_SIZE(screens); i++) {
+    lvmem_set_owner(screens[i]->name);
+    screens[i]->init();
+  }
 
-  // Initialize modes
+  // Initialize modes and the notification store
   modes_init();
+  model_init();
+  bus_init(subscribers, ARRAY_SIZE(subscribers));
 
   // Load default screen
   app_switch_screen(&watchface_screen);
@@ -109,32 +221,27 @@ int app_init(void) {
 
 // No message queue or posting logic here anymore
 
+uint32_t app_task_step(k_timeout_t timeout) {
+  app_event_t event;
+  uint32_t sleep;
+
+  while (event_get(&event, timeout) == 0) {
+    uint32_t dispatched_at = k_cycle_get_32();
+
+    bus_dispatch(&event);
+    event_release(&event);
+    event_trace_record(&event, dispatched_at);
+  }
+  sleep = lv_timer_handler();
+  if (sleep > 1000) {
+    sleep = 1000;
+  }
+  return sleep;
+}
+
 uint32_t app_task_handler(void) {
   uint32_t sleep = 1;
   while (1) {
-    app_event_t event;
-    while (event_get(&event, K_MSEC(sleep)) == 0) {
-      LOG_INF("Handling event type: %u", event.type);
-      if (event.type == APP_EVENT_BLE_ANCS) {
-        // App handles notification management first
-        if (event.ptr) {
-          model_add_notification((ancs_noti_info_t*)event.ptr);
-          k_free(event.ptr);
-          model_dump_notifications();
-        }
-      } else if (event.type == APP_EVENT_BUTTON) {
-        modes_activity_detected();
-      } else if (event.type == APP_EVENT_MODE_TIMEOUT) {
-        modes_handle_timeout();
-      }
-
-      if (current_screen && current_screen->handle_event) {
-        current_screen->handle_event(&event);
-      }
-    }
-    sleep = lv_timer_handler();
-    if (sleep > 1000) {
-      sleep = 1000;
-    }
+    sleep = app_task_step(K_MSEC(sleep));
   }
 }
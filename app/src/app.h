@@ -6,6 +6,12 @@
 int app_init(void);
 uint32_t app_task_handler(void);
 
+/**
+ * @brief Dispatch queued events, waiting up to @p timeout for each, then run LVGL once.
+ * @return Milliseconds until LVGL wants to run again, capped at 1000.
+ */
+uint32_t app_task_step(k_timeout_t timeout);
+
 struct screen;
 void app_switch_screen(struct screen* screen);
 
@@ -0,0 +1,54 @@
+#include "bus.h"
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(bus, LOG_LEVEL_INF);
+
+static bus_subscriber_t* const* table;
+static uint8_t table_count;
+
+/* Per event type, a bit per subscriber index that handles it */
+static uint32_t routes[APP_EVENT_COUNT];
+
+BUILD_ASSERT(BUS_MAX_SUBSCRIBERS <= 32, "routes hold one bit per subscriber");
+
+static void bus_route(void) {
+  uint32_t wanted = 0;
+
+  for (uint8_t t = 0; t < APP_EVENT_COUNT; t++) {
+    routes[t] = 0;
+    for (uint8_t i = 0; i < table_count; i++) {
+      if (table[i]->event_mask & BUS_ON(t)) {
+        routes[t] |= BIT(i);
+      }
+    }
+    if (routes[t]) {
+      wanted |= BUS_ON(t);
+    }
+  }
+  event_set_filter(wanted);
+}
+
+void bus_init(bus_subscriber_t* const* subscribers, uint8_t count) {
+  __ASSERT(count <= BUS_MAX_SUBSCRIBERS, "too many subscribers");
+  table = subscribers;
+  table_count = count;
+  bus_route();
+}
+
+void bus_set_mask(bus_subscriber_t* subscriber, uint32_t event_mask) {
+  if (subscriber->event_mask == event_mask) {
+    return;
+  }
+  subscriber->event_mask = event_mask;
+  bus_route();
+}
+
+void bus_dispatch(app_event_t* event) {
+  for (uint32_t route = routes[event->type]; route != 0; route &= route - 1) {
+    bus_subscriber_t* sub = table[find_lsb_set(route) - 1];
+
+    LOG_DBG("Event %u -> %s", event->type, sub->name);
+    sub->handle_event(event);
+  }
+}
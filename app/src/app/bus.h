@@ -0,0 +1,37 @@
+#ifndef APP_BUS_H
+#define APP_BUS_H
+
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+
+#include "../event.h"
+
+#define BUS_MAX_SUBSCRIBERS 8
+
+/* Build an event mask for subscribers */
+#define BUS_ON(type) BIT(type)
+
+typedef struct bus_subscriber {
+  const char* name;
+  uint32_t event_mask;  // BUS_ON() of the event types it handles
+  void (*handle_event)(app_event_t* event);
+} bus_subscriber_t;
+
+/**
+ * @brief Set the subscriber table. Each event is handed to its subscribers
+ * in table order, so a subscriber sees the state earlier ones left behind.
+ * Event types nobody subscribes to are no longer queued at all.
+ */
+void bus_init(bus_subscriber_t* const* subscribers, uint8_t count);
+
+/**
+ * @brief Change what @p subscriber receives, e.g. when the screen changes.
+ */
+void bus_set_mask(bus_subscriber_t* subscriber, uint32_t event_mask);
+
+/**
+ * @brief Hand @p event to the subscribers of its type.
+ */
+void bus_dispatch(app_event_t* event);
+
+#endif  // APP_BUS_H
@@ -0,0 +1,178 @@
+#include <lvgl.h>
+#include <zephyr/logging/log.h>
+
+#include "../../ui/ui.h"
+#include "../model.h"
+#include "faces.h"
+
+LOG_MODULE_REGISTER(classic_face);
+
+/* The count changes when notifications are added or removed, or dropped after a reconnect */
+#define NOTI_TRIGGERS                                                            \
+  (WATCHFACE_ON(APP_EVENT_BLE_ANCS) | WATCHFACE_ON(APP_EVENT_BLE_ANCS_REMOVED) | \
+   WATCHFACE_ON(APP_EVENT_BLE_ANCS_SYNCED))
+
+static lv_obj_t* second_label;
+
+static void classic_update_time(const watchface_ctx_t* ctx) {
+  lv_label_set_text_fmt(ui_HourLabel, "%02d", ctx->now.tm_hour);
+  lv_label_set_text_fmt(ui_MinuteLabel, "%02d", ctx->now.tm_min);
+}
+
+static void classic_update_ampm(const watchface_ctx_t* ctx) {
+  if (ctx->now.tm_hour < 12) {
+    lv_img_set_src(ui_Image2, &ui_img_sun_png);
+  } else {
+    lv_img_set_src(ui_Image2, &ui_img_moon_png);
+  }
+}
+
+static void classic_update_date(const watchface_ctx_t* ctx) {
+  static const char* months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+  lv_label_set_text_fmt(ui_Label6, "%s %d, %d", months[ctx->now.tm_mon], ctx->now.tm_mday, ctx->now.tm_year + 1900);
+}
+
+static void classic_update_week(const watchface_ctx_t* ctx) {
+  static lv_obj_t** const date_labels[7] = {&ui_day1, &ui_day2, &ui_day3, &ui_day4, &ui_day5, &ui_day6, &ui_day7};
+  // tm_wday: 0=Sun, 6=Sat; shift to 0=Mon
+  int wday = ctx->now.tm_wday == 0 ? 6 : ctx->now.tm_wday - 1;
+  int today = ctx->now.tm_mday;
+  int monday = today - wday;
+
+  for (int i = 0; i < 7; ++i) {
+    int d = monday + i;
+    lv_label_set_text_fmt(*date_labels[i], "%02d", d);
+    // Highlight current day with round rect border only, not filled
+    if (d == today) {
+      lv_obj_set_style_border_color(*date_labels[i], lv_color_black(), 0);
+      lv_obj_set_style_border_width(*date_labels[i], 2, 0);
+      // Rectangle border
+      lv_obj_set_style_radius(*date_labels[i], 1, 0);
+    } else {
+      lv_obj_set_style_border_width(*date_labels[i], 0, 0);
+    }
+  }
+}
+
+static void classic_update_battery(const watchface_ctx_t* ctx) {
+  static const lv_image_dsc_t* battery_icons[] = {
+      &ui_img_battery_status_0_png,  // empty
+      &ui_img_battery_status_1_png,  // 20%
+      &ui_img_battery_status_2_png,  // 40%
+      &ui_img_battery_status_3_png,  // 60%
+      &ui_img_battery_status_4_png,  // 80%
+      &ui_img_battery_status_5_png,  // full
+  };
+  uint8_t percent = ctx->battery & 0xFF;
+  bool is_charging = (ctx->battery >> 8) & 0x01;
+
+  int battery_index = percent / 20;
+  if (battery_index > 5) {
+    battery_index = 5;
+  }
+  LOG_INF("Battery percent: %u, charging: %d, index: %d", percent, is_charging, battery_index);
+  lv_img_set_src(ui_batteryIcon, battery_icons[battery_index]);
+  lv_label_set_text_fmt(ui_Label5, "%u%%", percent);
+
+  if (is_charging) {
+    lv_obj_remove_flag(ui_Image3, LV_OBJ_FLAG_HIDDEN);
+  } else {
+    lv_obj_add_flag(ui_Image3, LV_OBJ_FLAG_HIDDEN);
+  }
+}
+
+static void classic_update_noti_count(const watchface_ctx_t* ctx) {
+  (void)ctx;
+  lv_label_set_text_fmt(ui_numNoti, "%u", model_get_notification_count());
+}
+
+static void classic_update_second(const watchface_ctx_t* ctx) {
+  if (ctx->ambient) {
+    lv_obj_add_flag(second_label, LV_OBJ_FLAG_HIDDEN);
+    return;
+  }
+  lv_label_set_text_fmt(second_label, "%02d", ctx->now.tm_sec);
+  lv_obj_remove_flag(second_label, LV_OBJ_FLAG_HIDDEN);
+}
+
+/* Complications shared by the classic faces */
+#define CLASSIC_COMPLICATIONS                        \
+  {                                                  \
+      .name = "time",                                \
+      .triggers = WATCHFACE_ON(APP_EVENT_RTC_ALARM), \
+      .cadence = WATCHFACE_CADENCE_MINUTE,           \
+      .update = classic_update_time,                 \
+  },                                                 \
+  {                                                  \
+      .name = "ampm",                                \
+      .triggers = WATCHFACE_ON(APP_EVENT_RTC_ALARM), \
+      .cadence = WATCHFACE_CADENCE_HOUR,             \
+      .update = classic_update_ampm,                 \
+  },                                                 \
+  {                                                  \
+      .name = "date",                                \
+      .triggers = WATCHFACE_ON(APP_EVENT_RTC_ALARM), \
+      .cadence = WATCHFACE_CADENCE_DAY,              \
+      .update = classic_update_date,                 \
+  },                                                 \
+  {                                                  \
+      .name = "week",                                \
+      .triggers = WATCHFACE_ON(APP_EVENT_RTC_ALARM), \
+      .cadence = WATCHFACE_CADENCE_DAY,              \
+      .update = classic_update_week,                 \
+  },                                                 \
+  {                                                  \
+      .name = "battery",                             \
+      .triggers = WATCHFACE_ON(APP_EVENT_BATTERY),   \
+      .cadence = WATCHFACE_CADENCE_EVENT,            \
+      .update = classic_update_battery,              \
+  },                                                 \
+  {                                                  \
+      .name = "noti_count",                          \
+      .triggers = NOTI_TRIGGERS,                     \
+      .cadence = WATCHFACE_CADENCE_EVENT,            \
+      .update = classic_update_noti_count,           \
+  }
+
+static const complication_t classic_complications[] = {CLASSIC_COMPLICATIONS};
+
+static const complication_t classic_seconds_complications[] = {
+    CLASSIC_COMPLICATIONS,
+    {
+        .name = "second",
+        .triggers = WATCHFACE_ON(APP_EVENT_RTC_ALARM) | WATCHFACE_ON(APP_EVENT_RTC_SECOND),
+        .cadence = WATCHFACE_CADENCE_SECOND,
+        .update = classic_update_second,
+    },
+};
+
+static void classic_init(void) {
+  // ui_Screen1_screen_init() is already called in ui_init()
+}
+
+static void classic_seconds_init(void) {
+  // Both faces share ui_Screen1; the label stays hidden unless the ticker runs
+  second_label = lv_label_create(ui_Screen1);
+  lv_obj_set_style_text_font(second_label, &lv_font_montserrat_14, 0);
+  lv_obj_align(second_label, LV_ALIGN_TOP_RIGHT, -4, 84);
+  lv_obj_add_flag(second_label, LV_OBJ_FLAG_HIDDEN);
+}
+
+static lv_obj_t* classic_screen(void) { return ui_Screen1; }
+
+const watchface_t classic_face = {
+    .name = "classic",
+    .init = classic_init,
+    .screen = classic_screen,
+    .complications = classic_complications,
+    .complication_count = ARRAY_SIZE(classic_complications),
+};
+
+const watchface_t classic_seconds_face = {
+    .name = "classic_seconds",
+    .init = classic_seconds_init,
+    .screen = classic_screen,
+    .complications = classic_seconds_complications,
+    .complication_count = ARRAY_SIZE(classic_seconds_complications),
+};
@@ -0,0 +1,9 @@
+#include "faces.h"
+
+/* Watchface registry; the first entry is the default face */
+const watchface_t* const watchfaces[] = {
+    &classic_face,
+    &classic_seconds_face,
+};
+
+const uint8_t watchface_count = ARRAY_SIZE(watchfaces);
@@ -0,0 +1,9 @@
+#ifndef APP_FACES_H
+#define APP_FACES_H
+
+#include "../watchface.h"
+
+extern const watchface_t classic_face;
+extern const watchface_t classic_seconds_face;
+
+#endif  // APP_FACES_H
@@ -0,0 +1,197 @@
+#include "lvmem.h"
+
+#include <stdbool.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+
+LOG_MODULE_REGISTER(lvmem, LOG_LEVEL_INF);
+
+/*
+ * LVGL's allocator entry points, wrapped at link time (see CMakeLists.txt)
+ * around the Zephyr sys_heap pool. Each block carries a small header with
+ * its size and owner so frees can be accounted without asking the heap.
+ * LVGL only allocates from the UI thread; the counters are also read from
+ * the shell, so they are updated under a spinlock.
+ */
+void* __real_lv_malloc_core(size_t size);
+void* __real_lv_realloc_core(void* ptr, size_t size);
+void __real_lv_free_core(void* ptr);
+
+typedef struct {
+  uint32_t size;
+  uint8_t owner;
+  uint8_t reserved[3];  // keeps the payload 8-byte aligned
+} lvmem_hdr_t;
+
+BUILD_ASSERT(sizeof(lvmem_hdr_t) == 8);
+
+static struct lvmem_stats stats = {
+    .pool = CONFIG_LV_Z_MEM_POOL_SIZE,
+    .owner_count = 1,
+    .owners = {{.name = "system"}},
+};
+static uint8_t owner;
+static struct k_spinlock lock;
+
+/* The caller holds the lock */
+static void lvmem_account(lvmem_hdr_t* hdr, size_t size) {
+  struct lvmem_owner_stats* o = &stats.owners[owner];
+
+  hdr->size = size;
+  hdr->owner = owner;
+  stats.current += size;
+  stats.count++;
+  stats.allocs++;
+  stats.peak = MAX(stats.peak, stats.current);
+  o->current += size;
+  o->count++;
+  o->allocs++;
+}
+
+/* The caller holds the lock */
+static void lvmem_release(const lvmem_hdr_t* hdr) {
+  struct lvmem_owner_stats* o = &stats.owners[hdr->owner];
+
+  stats.current -= hdr->size;
+  stats.count--;
+  o->current -= hdr->size;
+  o->count--;
+}
+
+/* Largest block the pool can still hand out, found by bisecting trial allocations */
+static uint32_t lvmem_largest_free(void) {
+  uint32_t lo = 0;
+  uint32_t hi = stats.pool;
+
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo + 1) / 2;
+    void* p = __real_lv_malloc_core(mid);
+
+    if (p) {
+      __real_lv_free_core(p);
+      lo = mid;
+    } else {
+      hi = mid - 1;
+    }
+  }
+  return lo;
+}
+
+static void lvmem_failed(size_t size) {
+  uint32_t largest = lvmem_largest_free();
+  k_spinlock_key_t key = k_spin_lock(&lock);
+
+  stats.failures++;
+  stats.largest_free = largest;
+  k_spin_unlock(&lock, key);
+  LOG_ERR("LVGL alloc of %zu B failed: %u B live in %u blocks, largest free %u B", size, stats.current, stats.count,
+          stats.largest_free);
+}
+
+void* __wrap_lv_malloc_core(size_t size) {
+  lvmem_hdr_t* hdr = __real_lv_malloc_core(sizeof(*hdr) + size);
+
+  if (hdr == NULL) {
+    lvmem_failed(size);
+    return NULL;
+  }
+
+  k_spinlock_key_t key = k_spin_lock(&lock);
+  lvmem_account(hdr, size);
+  k_spin_unlock(&lock, key);
+  return hdr + 1;
+}
+
+void* __wrap_lv_realloc_core(void* ptr, size_t size) {
+  if (ptr == NULL) {
+    return __wrap_lv_malloc_core(size);
+  }
+
+  lvmem_hdr_t* hdr = (lvmem_hdr_t*)ptr - 1;
+  lvmem_hdr_t old = *hdr;
+  lvmem_hdr_t* moved = __real_lv_realloc_core(hdr, sizeof(*hdr) + size);
+
+  if (moved == NULL) {
+    // The old block is untouched and still accounted
+    lvmem_failed(size);
+    return NULL;
+  }
+
+  k_spinlock_key_t key = k_spin_lock(&lock);
+  lvmem_release(&old);
+  lvmem_account(moved, size);
+  k_spin_unlock(&lock, key);
+  return moved + 1;
+}
+
+void __wrap_lv_free_core(void* ptr) {
+  if (ptr == NULL) {
+    return;
+  }
+
+  lvmem_hdr_t* hdr = (lvmem_hdr_t*)ptr - 1;
+  k_spinlock_key_t key = k_spin_lock(&lock);
+
+  lvmem_release(hdr);
+  k_spin_unlock(&lock, key);
+  __real_lv_free_core(hdr);
+}
+
+void lvmem_set_owner(const char* name) {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+
+  for (owner = 0; owner < stats.owner_count; owner++) {
+    if (stats.owners[owner].name == name) {
+      k_spin_unlock(&lock, key);
+      return;
+    }
+  }
+  if (stats.owner_count < LVMEM_MAX_OWNERS) {
+    stats.owners[stats.owner_count++].name = name;
+  } else {
+    // Out of slots: the last one is shared, its first owner's name would mislead
+    owner = LVMEM_MAX_OWNERS - 1;
+    stats.owners[owner].name = "other";
+  }
+  k_spin_unlock(&lock, key);
+}
+
+void lvmem_stats_get(struct lvmem_stats* out) {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+
+  *out = stats;
+  k_spin_unlock(&lock, key);
+}
+
+void lvmem_log(void) {
+  uint32_t largest = lvmem_largest_free();
+  uint32_t free_bytes = stats.pool - MIN(stats.pool, stats.current + stats.count * sizeof(lvmem_hdr_t));
+  k_spinlock_key_t key = k_spin_lock(&lock);
+
+  stats.largest_free = largest;
+  k_spin_unlock(&lock, key);
+  // Fragmentation: share of the free space that is not in the largest block
+  LOG_INF("LVGL heap: %u B in %u blocks, peak %u/%u B, largest free %u B, frag %u%%, %u failed", stats.current,
+          stats.count, stats.peak, stats.pool, largest, free_bytes ? 100 - MIN(100, largest * 100 / free_bytes) : 0,
+          stats.failures);
+}
+
+#ifdef CONFIG_SHELL
+static int cmd_lvmem(const struct shell* sh, size_t argc, char** argv) {
+  struct lvmem_stats s;
+
+  lvmem_stats_get(&s);
+  shell_print(sh, "pool %u B, live %u B in %u blocks, peak %u B", s.pool, s.current, s.count, s.peak);
+  shell_print(sh, "largest free %u B at last screen switch, allocs %u, failures %u", s.largest_free, s.allocs,
+              s.failures);
+  for (uint8_t i = 0; i < s.owner_count; i++) {
+    shell_print(sh, "  %-12s %6u B %4u blocks %6u allocs", s.owners[i].name, s.owners[i].current, s.owners[i].count,
+                s.owners[i].allocs);
+  }
+  return 0;
+}
+
+SHELL_SUBCMD_ADD((diag), lvmem, NULL, "LVGL heap usage per screen", cmd_lvmem, 1, 0);
+#endif
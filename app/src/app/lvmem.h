@@ -0,0 +1,48 @@
+#ifndef APP_LVMEM_H
+#define APP_LVMEM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define LVMEM_MAX_OWNERS 8
+
+/* LVGL heap usage of one owner, the screen that was current at allocation time */
+struct lvmem_owner_stats {
+  const char* name;
+  uint32_t current;  // live bytes
+  uint32_t count;    // live allocations
+  uint32_t allocs;   // allocations since boot
+};
+
+struct lvmem_stats {
+  uint32_t pool;      // CONFIG_LV_Z_MEM_POOL_SIZE
+  uint32_t current;   // live bytes requested by LVGL, headers excluded
+  uint32_t peak;      // high-water mark of current
+  uint32_t count;     // live allocations
+  uint32_t allocs;    // allocations since boot
+  uint32_t failures;  // allocations the pool could not satisfy
+  uint32_t largest_free;  // as of the last lvmem_log() or failed allocation
+  uint8_t owner_count;
+  struct lvmem_owner_stats owners[LVMEM_MAX_OWNERS];
+};
+
+/**
+ * @brief Charge LVGL allocations from now on to @p name (a screen name).
+ * Owners are matched by pointer; names beyond LVMEM_MAX_OWNERS share the last
+ * slot, which is then reported as "other".
+ */
+void lvmem_set_owner(const char* name);
+
+/**
+ * @brief Snapshot the counters. Safe to call from any thread.
+ */
+void lvmem_stats_get(struct lvmem_stats* stats);
+
+/**
+ * @brief Log a one-line summary of the LVGL heap, including fragmentation.
+ * Probes the largest free block with trial allocations, so call it from
+ * the LVGL thread and not on a hot path.
+ */
+void lvmem_log(void);
+
+#endif  // APP_LVMEM_H
@@ -1,64 +1,646 @@
 #include "model.h"
 
+#include <errno.h>
+#include <stddef.h>
 #include <string.h>
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 
+#include "noti_store.h"
+
 LOG_MODULE_REGISTER(model);
 
-static ancs_noti_info_t notifications[MAX_NOTIFICATIONS];
-static uint8_t noti_count = 0;
-static uint8_t head = 0;  // Index for the next new notification
+/* New notifications reach flash after a quiet period, or once this many are waiting */
+#define MODEL_FLUSH_MS 5000
+#define MODEL_FLUSH_BATCH 8
+
+/* Messages kept in RAM once fetched or read back, the least recently read one is replaced */
+#define MODEL_BODY_CACHE 4
+
+/* Record header; app and title follow, each NUL-terminated */
+struct model_rec {
+  uint16_t size;  // header and strings, rounded up to MODEL_REC_ALIGN
+  uint8_t app_len;
+  uint8_t title_len;
+};
+
+#define MODEL_REC_ALIGN 2
+
+BUILD_ASSERT(sizeof(struct model_rec) + sizeof(((ancs_noti_info_t*)0)->app) + sizeof(((ancs_noti_info_t*)0)->title) <=
+                 MODEL_ARENA_SIZE,
+             "a single notification must fit the arena");
+BUILD_ASSERT(MODEL_MAX_NOTIFICATIONS <= NOTI_STORE_SLOTS, "every listed notification needs a flash slot");
+
+static uint8_t arena[MODEL_ARENA_SIZE] __aligned(MODEL_REC_ALIGN);
+static uint16_t write_off;  // where the next record goes if it fits
+
+/* Arena record offsets, oldest at rec_first; the arena holds the newest arena_count notifications */
+static uint16_t rec_off[MODEL_MAX_NOTIFICATIONS];
+static uint8_t rec_first;
+static uint8_t arena_count;
+
+/*
+ * Notifications are numbered in arrival order. Bit k of live is set while
+ * notification seq_next - 1 - k is listed; it comes from the arena or, if
+ * it is older than the arena, from flash. Those before seq_flushed are in
+ * flash, as are the ones changed in the arena with their dirty bit set.
+ */
+static uint32_t seq_next;
+static uint32_t seq_flushed;
+static uint64_t live;
+static uint64_t dirty;
+static bool persistent;
+
+/*
+ * A new ANCS session replays the phone's notifications with new UIDs. Bit k
+ * of stale is set while notification seq_next - 1 - k is from an earlier
+ * session and has not been replayed; a replayed head takes it over by its
+ * app and title key, the rest go once the backlog is in.
+ */
+static uint64_t stale;
+static uint32_t slot_key[MODEL_MAX_NOTIFICATIONS];
+static uint64_t keyed;  // BIT64(slot) once slot_key holds the key; flash entries get it on demand
+
+BUILD_ASSERT(MODEL_MAX_NOTIFICATIONS == 64, "live holds one bit per notification");
+
+/*
+ * ANCS UID of each notification, by seq % MODEL_MAX_NOTIFICATIONS, and an
+ * open-addressing (linear probing) hash from UID to that slot, so ANCS
+ * Removed and Modified events find their notification in O(1).
+ */
+#define UID_HASH_SIZE (2 * MODEL_MAX_NOTIFICATIONS)
+#define UID_HASH_EMPTY 0xFF
+
+static uint32_t slot_uid[MODEL_MAX_NOTIFICATIONS];
+static uint32_t uid_keys[UID_HASH_SIZE];
+static uint8_t uid_slots[UID_HASH_SIZE] = {[0 ... UID_HASH_SIZE - 1] = UID_HASH_EMPTY};
+
+static model_change_t last_change;
+
+/* Arena updates versus the flush work */
+static K_MUTEX_DEFINE(lock);
+static void model_flush_work_fn(struct k_work* work);
+static K_WORK_DELAYABLE_DEFINE(flush_work, model_flush_work_fn);
+
+/* Flash head record: lengths, then app and title, NUL-terminated */
+struct model_head {
+  uint8_t app_len;
+  uint8_t title_len;
+  char strings[sizeof(((ancs_noti_info_t*)0)->app) + sizeof(((ancs_noti_info_t*)0)->title)];
+};
+
+/* Last notification read back from flash */
+static struct model_head head_buf;
+
+/*
+ * Messages are not part of the records: they are fetched from the phone when
+ * a notification is opened and kept here, and in flash once the head is.
+ */
+struct model_body {
+  uint32_t seq;
+  uint32_t used;  // body_clock when last read, 0 if free
+  char text[sizeof(((ancs_noti_body_t*)0)->message)];
+};
+
+static struct model_body bodies[MODEL_BODY_CACHE];
+static uint32_t body_clock;
+static bool fetching;  // a message fetch for fetching_seq is in flight
+static uint32_t fetching_seq;
+
+static uint32_t uid_hash_home(uint32_t uid) { return (uid * 2654435761u) % UID_HASH_SIZE; }
+
+static int uid_hash_find(uint32_t uid) {
+  for (uint32_t i = uid_hash_home(uid); uid_slots[i] != UID_HASH_EMPTY; i = (i + 1) % UID_HASH_SIZE) {
+    if (uid_keys[i] == uid) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/* FNV-1a over app, NUL and title */
+static uint32_t model_key(const char* app, const char* title) {
+  uint32_t h = 2166136261u;
+
+  for (const char* p = app;; p++) {
+    h = (h ^ (uint8_t)*p) * 16777619u;
+    if (*p == '\0') {
+      break;
+    }
+  }
+  for (const char* p = title; *p; p++) {
+    h = (h ^ (uint8_t)*p) * 16777619u;
+  }
+  return h;
+}
+
+static void uid_hash_insert(uint32_t uid, uint8_t slot) {
+  uint32_t i = uid_hash_home(uid);
+
+  while (uid_slots[i] != UID_HASH_EMPTY && uid_keys[i] != uid) {
+    i = (i + 1) % UID_HASH_SIZE;
+  }
+  uid_keys[i] = uid;
+  uid_slots[i] = slot;
+}
+
+/* Backward-shift deletion keeps probe chains intact without tombstones */
+static void uid_hash_remove_at(uint32_t hole) {
+  for (uint32_t i = (hole + 1) % UID_HASH_SIZE; uid_slots[i] != UID_HASH_EMPTY; i = (i + 1) % UID_HASH_SIZE) {
+    uint32_t home = uid_hash_home(uid_keys[i]);
+    // Move the entry into the hole unless its home lies cyclically in (hole, i]
+    if ((i - home) % UID_HASH_SIZE >= (i - hole) % UID_HASH_SIZE) {
+      uid_keys[hole] = uid_keys[i];
+      uid_slots[hole] = uid_slots[i];
+      hole = i;
+    }
+  }
+  uid_slots[hole] = UID_HASH_EMPTY;
+}
+
+static uint8_t seq_age(uint32_t seq) { return seq_next - 1 - seq; }
+
+static struct model_body* body_find(uint32_t seq) {
+  for (int i = 0; i < MODEL_BODY_CACHE; i++) {
+    if (bodies[i].used && bodies[i].seq == seq) {
+      return &bodies[i];
+    }
+  }
+  return NULL;
+}
+
+/* Entry for @p seq, taking over the least recently read one if it has none */
+static struct model_body* body_claim(uint32_t seq) {
+  struct model_body* body = body_find(seq);
+
+  if (body == NULL) {
+    body = &bodies[0];
+    for (int i = 1; i < MODEL_BODY_CACHE; i++) {
+      if (bodies[i].used < body->used) {
+        body = &bodies[i];
+      }
+    }
+    body->seq = seq;
+  }
+  body->used = ++body_clock;
+  return body;
+}
+
+static void body_drop(uint32_t seq) {
+  struct model_body* body = body_find(seq);
+
+  if (body) {
+    body->used = 0;
+  }
+  if (fetching && fetching_seq == seq) {
+    fetching = false;
+  }
+}
+
+/* Notification in the window that uses @p slot */
+static uint32_t slot_seq(uint8_t slot) { return seq_next - 1 - ((seq_next - 1 - slot) % MODEL_MAX_NOTIFICATIONS); }
+
+/* Position of a listed notification, 0 is the most recent */
+static uint8_t seq_index(uint32_t seq) { return __builtin_popcountll(live & (BIT64(seq_age(seq)) - 1)); }
+
+static uint32_t index_seq(uint8_t index) {
+  uint64_t m = live;
+
+  for (; index > 0; index--) {
+    m &= m - 1;
+  }
+  return seq_next - 1 - __builtin_ctzll(m);
+}
+
+/* Stop listing @p seq; the caller holds the lock */
+static void model_unlist(uint32_t seq) {
+  uint8_t slot = seq % MODEL_MAX_NOTIFICATIONS;
+  int h = uid_hash_find(slot_uid[slot]);
+
+  live &= ~BIT64(seq_age(seq));
+  dirty &= ~BIT64(seq_age(seq));
+  stale &= ~BIT64(seq_age(seq));
+  body_drop(seq);
+  // Notifications loaded from flash have no UID
+  if (h >= 0 && uid_slots[h] == slot) {
+    uid_hash_remove_at(h);
+  }
+  if (persistent) {
+    noti_store_delete(seq);
+  }
+}
+
+static struct model_rec* model_rec_at(uint8_t slot) { return (struct model_rec*)&arena[rec_off[slot]]; }
+
+static struct model_rec* model_arena_rec(uint32_t seq) {
+  return model_rec_at((rec_first + arena_count - 1 - seq_age(seq)) % MODEL_MAX_NOTIFICATIONS);
+}
+
+static bool model_in_arena(uint32_t seq) { return seq_age(seq) < arena_count; }
+
+static int model_store(uint32_t seq) {
+  const struct model_rec* rec = model_arena_rec(seq);
+  const struct model_body* body = body_find(seq);
+  struct model_head head = {.app_len = rec->app_len, .title_len = rec->title_len};
+  size_t strings_len = rec->app_len + rec->title_len + 2;
+
+  memcpy(head.strings, rec + 1, strings_len);
+  // A message fetched before the head reached flash goes with it
+  return noti_store_write(seq, &head, offsetof(struct model_head, strings) + strings_len, body ? body->text : NULL,
+                          body ? strlen(body->text) : 0);
+}
+
+/* Write new and changed notifications and the index to flash; the caller holds the lock */
+static void model_flush_locked(void) {
+  for (uint32_t seq = seq_next - arena_count; seq < seq_next; seq++) {
+    uint64_t bit = BIT64(seq_age(seq));
+
+    if (!(live & bit) || (seq < seq_flushed && !(dirty & bit))) {
+      continue;
+    }
+    int err = model_store(seq);
+    // Out of space: give up the oldest stored notifications until it fits
+    while (err == -ENOSPC && (live & ~(bit | (bit - 1)))) {
+      model_unlist(seq_next - 64 + __builtin_clzll(live));
+      err = model_store(seq);
+    }
+    if (err) {
+      LOG_ERR("Failed to store notification %u: %d", seq, err);
+      model_unlist(seq);
+    }
+  }
+  seq_flushed = seq_next;
+  dirty = 0;
+
+  struct noti_store_index index = {.next = seq_next, .live = live};
+  noti_store_set_index(&index);
+}
+
+static void model_flush_work_fn(struct k_work* work) {
+  k_mutex_lock(&lock, K_FOREVER);
+  model_flush_locked();
+  k_mutex_unlock(&lock);
+}
+
+/* Batch bursts into one flash update, but bound what a reset can lose */
+static void model_schedule_flush(void) {
+  if (persistent) {
+    k_work_reschedule(&flush_work, seq_next - seq_flushed >= MODEL_FLUSH_BATCH ? K_NO_WAIT : K_MSEC(MODEL_FLUSH_MS));
+  }
+}
+
+static void model_evict_oldest(void) {
+  uint32_t seq = seq_next - arena_count;
+
+  if (persistent && (seq >= seq_flushed || (dirty & BIT64(seq_age(seq))))) {
+    model_flush_locked();
+  }
+  if (!persistent && (live & BIT64(seq_age(seq)))) {
+    model_unlist(seq);
+  }
+  rec_first = (rec_first + 1) % MODEL_MAX_NOTIFICATIONS;
+  if (--arena_count == 0) {
+    write_off = 0;
+  }
+}
+
+/*
+ * Find room for @p size contiguous bytes, evicting the oldest records until
+ * it fits. Records never wrap, so the tail of the arena may stay unused.
+ */
+static uint16_t model_reserve(uint16_t size) {
+  while (arena_count > 0) {
+    uint16_t oldest = rec_off[rec_first];
+
+    if (arena_count < MODEL_MAX_NOTIFICATIONS) {
+      if (write_off > oldest) {
+        // Live bytes are [oldest, write_off): free space at the end, then the start
+        if (write_off + size <= MODEL_ARENA_SIZE) {
+          return write_off;
+        }
+        if (size <= oldest) {
+          return 0;
+        }
+      } else if (write_off + size <= oldest) {
+        // Wrapped: live bytes are [oldest, end) and [0, write_off)
+        return write_off;
+      }
+    }
+    model_evict_oldest();
+  }
+  return 0;
+}
+
+static uint16_t model_rec_size(const ancs_noti_info_t* noti) {
+  size_t strings = strnlen(noti->app, sizeof(noti->app) - 1) + strnlen(noti->title, sizeof(noti->title) - 1) + 2;
+
+  return ROUND_UP(sizeof(struct model_rec) + strings, MODEL_REC_ALIGN);
+}
+
+static void model_rec_fill(struct model_rec* rec, const ancs_noti_info_t* noti) {
+  char* p = (char*)(rec + 1);
+
+  rec->app_len = strnlen(noti->app, sizeof(noti->app) - 1);
+  rec->title_len = strnlen(noti->title, sizeof(noti->title) - 1);
+  memcpy(p, noti->app, rec->app_len);
+  p[rec->app_len] = '\0';
+  p += rec->app_len + 1;
+  memcpy(p, noti->title, rec->title_len);
+  p[rec->title_len] = '\0';
+}
+
+/*
+ * Give a replayed notification the stale entry with the same app and title,
+ * newest first; the caller holds the lock. Flash entries are read once for
+ * their key.
+ */
+static bool model_adopt(const ancs_noti_info_t* noti) {
+  uint32_t key = model_key(noti->app, noti->title);
+
+  for (uint64_t m = stale; m != 0; m &= m - 1) {
+    uint32_t seq = seq_next - 1 - __builtin_ctzll(m);
+    uint8_t slot = seq % MODEL_MAX_NOTIFICATIONS;
+
+    if (!(keyed & BIT64(slot))) {
+      model_noti_t n;
+
+      if (!model_get_notification(seq_index(seq), &n)) {
+        continue;
+      }
+      slot_key[slot] = model_key(n.app, n.title);
+      keyed |= BIT64(slot);
+    }
+    if (slot_key[slot] == key) {
+      stale &= ~BIT64(seq_age(seq));
+      slot_uid[slot] = noti->uid;
+      uid_hash_insert(noti->uid, slot);
+      return true;
+    }
+  }
+  return false;
+}
+
+void model_init(void) {
+  struct noti_store_index index;
+
+  persistent = noti_store_init(&index) == 0;
+  if (persistent) {
+    // UIDs are only valid for one ANCS session, stored notifications have none
+    seq_next = index.next;
+    seq_flushed = index.next;
+    live = index.live;
+  }
+}
 
 void model_add_notification(const ancs_noti_info_t* noti) {
   if (noti == NULL) {
     return;
   }
 
-  LOG_INF("Adding notification: %s - %s - %s", noti->title, noti->message, noti->app);
+  LOG_INF("Adding notification %u: %s - %s", noti->uid, noti->title, noti->app);
+
+  uint16_t size = model_rec_size(noti);
+
+  k_mutex_lock(&lock, K_FOREVER);
+  int found = uid_hash_find(noti->uid);
+  last_change = (model_change_t){.removed = -1, .updated = -1};
+  if (found >= 0) {
+    uint32_t seq = slot_seq(uid_slots[found]);
+    uint8_t index = seq_index(seq);
+
+    if (model_in_arena(seq) && size <= model_arena_rec(seq)->size) {
+      // Modified and still fits its record: rewrite it where it is, the message is fetched again
+      model_rec_fill(model_arena_rec(seq), noti);
+      body_drop(seq);
+      if (seq < seq_flushed) {
+        dirty |= BIT64(seq_age(seq));
+        if (persistent) {
+          noti_store_write_body(seq, NULL, 0);
+        }
+      }
+      last_change.updated = index;
+      k_mutex_unlock(&lock);
+      model_schedule_flush();
+      return;
+    }
+    // Otherwise it moves to the top like a new one
+    model_unlist(seq);
+    last_change.removed = index;
+  } else if ((noti->flags & ANCS_NOTI_PRE_EXISTING) && model_adopt(noti)) {
+    // Already listed from the last session, nothing to show or store
+    k_mutex_unlock(&lock);
+    return;
+  }
+
+  uint16_t off = model_reserve(size);
+  struct model_rec* rec = (struct model_rec*)&arena[off];
+
+  rec->size = size;
+  model_rec_fill(rec, noti);
+  rec_off[(rec_first + arena_count) % MODEL_MAX_NOTIFICATIONS] = off;
+  arena_count++;
+  write_off = off + size;
+
+  // The slot is reused: the notification leaving the window goes
+  if (live & BIT64(MODEL_MAX_NOTIFICATIONS - 1)) {
+    model_unlist(seq_next - MODEL_MAX_NOTIFICATIONS);
+  }
+  seq_next++;
+  live = (live << 1) | 1;
+  dirty <<= 1;
+  stale <<= 1;
+  if (!persistent) {
+    seq_flushed = seq_next;
+  }
+  uint8_t slot = (seq_next - 1) % MODEL_MAX_NOTIFICATIONS;
+  slot_uid[slot] = noti->uid;
+  slot_key[slot] = model_key(noti->app, noti->title);
+  keyed |= BIT64(slot);
+  uid_hash_insert(noti->uid, slot);
+  last_change.added = true;
+  k_mutex_unlock(&lock);
+
+  model_schedule_flush();
+  LOG_DBG("Stored %u B at %u, %u notifications", size, off, model_get_notification_count());
+}
+
+void model_remove_notification(uint32_t uid) {
+  k_mutex_lock(&lock, K_FOREVER);
+  int found = uid_hash_find(uid);
+
+  last_change = (model_change_t){.removed = -1, .updated = -1};
+  if (found < 0) {
+    k_mutex_unlock(&lock);
+    return;
+  }
+
+  uint32_t seq = slot_seq(uid_slots[found]);
+
+  last_change.removed = seq_index(seq);
+  model_unlist(seq);
+  k_mutex_unlock(&lock);
 
-  // If we are overwriting an existing notification, free its strings
-  if (noti_count == MAX_NOTIFICATIONS) {
-    if (notifications[head].title) k_free(notifications[head].title);
-    if (notifications[head].message) k_free(notifications[head].message);
-    if (notifications[head].app) k_free(notifications[head].app);
+  // Persists the index; the records are already deleted
+  model_schedule_flush();
+  LOG_INF("Removed notification %u at %d", uid, last_change.removed);
+}
+
+void model_session_start(void) {
+  k_mutex_lock(&lock, K_FOREVER);
+  // Entries stay listed until the backlog says whether the phone still has them
+  memset(uid_slots, UID_HASH_EMPTY, sizeof(uid_slots));
+  stale = live;
+  fetching = false;
+  last_change = (model_change_t){.removed = -1, .updated = -1};
+  k_mutex_unlock(&lock);
+}
+
+void model_session_synced(void) {
+  k_mutex_lock(&lock, K_FOREVER);
+  last_change = (model_change_t){.removed = -1, .updated = -1, .reset = stale != 0};
+  if (stale != 0) {
+    LOG_INF("Dropping %u notifications gone from the phone", __builtin_popcountll(stale));
+  }
+  while (stale != 0) {
+    model_unlist(seq_next - 1 - __builtin_ctzll(stale));
   }
+  k_mutex_unlock(&lock);
 
-  // Copy notification (shallow copy of pointers to transfer ownership)
-  notifications[head] = *noti;
+  if (last_change.reset) {
+    model_schedule_flush();
+  }
+}
+
+const model_change_t* model_last_change(void) { return &last_change; }
 
-  // Update head (circularly)
-  head = (head + 1) % MAX_NOTIFICATIONS;
-  LOG_INF("Updated head to: %d", head);
+uint8_t model_get_notification_count(void) { return __builtin_popcountll(live); }
 
-  // Update count (up to MAX)
-  if (noti_count < MAX_NOTIFICATIONS) {
-    noti_count++;
+bool model_get_notification(uint8_t index, model_noti_t* out) {
+  if (index >= model_get_notification_count()) {
+    return false;
   }
-  LOG_INF("Updated noti_count to: %d", noti_count);
+
+  // Most recent first
+  uint32_t seq = index_seq(index);
+  if (model_in_arena(seq)) {
+    const struct model_rec* rec = model_arena_rec(seq);
+
+    out->app = (const char*)(rec + 1);
+    out->title = out->app + rec->app_len + 1;
+    return true;
+  }
+
+  ssize_t len = noti_store_read_head(seq, &head_buf, sizeof(head_buf));
+  if (len < (ssize_t)offsetof(struct model_head, strings) + head_buf.app_len + head_buf.title_len + 2) {
+    LOG_WRN("Notification %u not readable: %d", seq, (int)len);
+    return false;
+  }
+  out->app = head_buf.strings;
+  out->title = head_buf.strings + head_buf.app_len + 1;
+  return true;
+}
+
+/* ANCS UID of a listed notification; those loaded from flash have none */
+static bool model_seq_uid(uint32_t seq, uint32_t* uid) {
+  uint8_t slot = seq % MODEL_MAX_NOTIFICATIONS;
+  int h = uid_hash_find(slot_uid[slot]);
+
+  *uid = slot_uid[slot];
+  return h >= 0 && uid_slots[h] == slot;
 }
 
-uint8_t model_get_notification_count(void) { return noti_count; }
+const char* model_get_message(uint8_t index) {
+  uint32_t uid;
 
-const ancs_noti_info_t* model_get_notification(uint8_t index) {
-  if (index >= noti_count) {
-    return NULL;
+  if (index >= model_get_notification_count()) {
+    return "";
   }
 
-  // Browsing should probably be in reverse order (most recent first)
-  // Most recent is at (head - 1 + MAX) % MAX
-  // Second most recent at (head - 2 + MAX) % MAX
-  int8_t target_idx = (int8_t)head - 1 - index;
-  while (target_idx < 0) {
-    target_idx += MAX_NOTIFICATIONS;
+  k_mutex_lock(&lock, K_FOREVER);
+  uint32_t seq = index_seq(index);
+  struct model_body* body = body_find(seq);
+
+  if (body == NULL && persistent && seq < seq_flushed) {
+    body = body_claim(seq);
+    ssize_t len = noti_store_read_body(seq, body->text, sizeof(body->text) - 1);
+    if (len < 0) {
+      body->used = 0;
+      body = NULL;
+    } else {
+      body->text[MIN(len, (ssize_t)sizeof(body->text) - 1)] = '\0';
+    }
+  }
+  if (body) {
+    body->used = ++body_clock;
+    k_mutex_unlock(&lock);
+    return body->text;
   }
 
-  return &notifications[target_idx];
+  // Not fetched yet: ask the phone once, the screen shows it when it arrives
+  if (!(fetching && fetching_seq == seq)) {
+    fetching = model_seq_uid(seq, &uid) && ancs_client_request_message(uid) == 0;
+    fetching_seq = seq;
+  }
+  k_mutex_unlock(&lock);
+  return fetching ? NULL : "";
+}
+
+void model_set_message(const ancs_noti_body_t* msg) {
+  k_mutex_lock(&lock, K_FOREVER);
+  int found = uid_hash_find(msg->uid);
+
+  last_change = (model_change_t){.removed = -1, .updated = -1};
+  if (found < 0) {
+    // Removed while the message was on its way
+    k_mutex_unlock(&lock);
+    return;
+  }
+
+  uint32_t seq = slot_seq(uid_slots[found]);
+  struct model_body* body = body_claim(seq);
+  size_t len = strnlen(msg->message, sizeof(msg->message) - 1);
+
+  memcpy(body->text, msg->message, len);
+  body->text[len] = '\0';
+  if (fetching && fetching_seq == seq) {
+    fetching = false;
+  }
+  // Otherwise it is written with the head on the next flush
+  if (persistent && seq < seq_flushed) {
+    noti_store_write_body(seq, body->text, len);
+  }
+  last_change.updated = seq_index(seq);
+  k_mutex_unlock(&lock);
 }
 
 void model_dump_notifications(void) {
-  for (int i = 0; i < noti_count; i++) {
-    const ancs_noti_info_t* n = model_get_notification(i);
-    LOG_INF("Notification %d: %s - %s - %s", i, n->title, n->message, n->app);
+  model_noti_t n;
+
+  for (int i = 0; i < model_get_notification_count(); i++) {
+    if (model_get_notification(i, &n)) {
+      LOG_DBG("Notification %d: %s - %s", i, n.title, n.app);
+    }
   }
 }
+
+static void model_handle_event(app_event_t* event) {
+  if (event->type == APP_EVENT_BLE_ANCS_SESSION) {
+    model_session_start();
+  } else if (event->type == APP_EVENT_BLE_ANCS_SYNCED) {
+    model_session_synced();
+  } else if (event->type == APP_EVENT_BLE_ANCS_REMOVED) {
+    model_remove_notification(event->value);
+  } else if (event->type == APP_EVENT_BLE_ANCS_BODY) {
+    model_set_message((ancs_noti_body_t*)event->ptr);
+  } else if (event->ptr) {
+    // Copied into the arena, the payload block goes back to its pool after dispatch
+    model_add_notification((ancs_noti_info_t*)event->ptr);
+  }
+}
+
+bus_subscriber_t model_subscriber = {
+    .name = "model",
+    .event_mask = BUS_ON(APP_EVENT_BLE_ANCS) | BUS_ON(APP_EVENT_BLE_ANCS_REMOVED) | BUS_ON(APP_EVENT_BLE_ANCS_BODY) |
+                  BUS_ON(APP_EVENT_BLE_ANCS_SESSION) | BUS_ON(APP_EVENT_BLE_ANCS_SYNCED),
+    .handle_event = model_handle_event,
+};
@@ -1,16 +1,93 @@
 #ifndef APP_MODEL_H
 #define APP_MODEL_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "../hal/ancs_client.h"
+#include "bus.h"
 
-#define MAX_NOTIFICATIONS 10
+/*
+ * The newest notifications are kept as length-prefixed records in a fixed
+ * byte arena; the oldest ones are evicted when the newest does not fit.
+ * With a notification partition they are also written to flash in batches
+ * and older ones are read back from there on demand. Messages are fetched
+ * from the phone only when a notification is opened.
+ */
+#define MODEL_ARENA_SIZE 4096
+#define MODEL_MAX_NOTIFICATIONS 64
 
+/* Strings of one stored notification, valid until the next model call */
+typedef struct {
+  const char* app;
+  const char* title;
+} model_noti_t;
+
+/**
+ * @brief Pick up the notifications stored in flash. Only their range is read.
+ */
+void model_init(void);
+
+/* What the last add or remove did, so screens only redraw the entries that moved */
+typedef struct {
+  int16_t removed;  // index that went away (0 = newest), -1 if none
+  int16_t updated;  // index changed in place, -1 if none
+  bool added;       // a notification was put at index 0
+  bool reset;       // entries went away anywhere in the list, redraw it all
+} model_change_t;
+
+/**
+ * @brief Add a notification, or update the one with the same UID. An update
+ * is done in place if the new text fits, otherwise it moves to the top.
+ */
 void model_add_notification(const ancs_noti_info_t* noti);
+
+/**
+ * @brief Drop the notification with ANCS UID @p uid, if listed.
+ */
+void model_remove_notification(uint32_t uid);
+
+/**
+ * @brief Stop matching listed notifications by UID, since ANCS UIDs are only
+ * valid within one session, and mark them stale. A notification the phone
+ * replays (PreExisting) with the same app and title takes over its stale
+ * entry instead of being added again.
+ */
+void model_session_start(void);
+
+/**
+ * @brief The phone's backlog is in: drop the stale entries it did not
+ * replay, reported as a reset.
+ */
+void model_session_synced(void);
+
+const model_change_t* model_last_change(void);
+
 uint8_t model_get_notification_count(void);
-const ancs_noti_info_t* model_get_notification(uint8_t index);
+
+/**
+ * @brief Look up a notification, 0 is the most recent.
+ * @return false if @p index is out of range.
+ */
+bool model_get_notification(uint8_t index, model_noti_t* out);
+
+/**
+ * @brief Message of a notification, from the cache of recently read ones or
+ * flash. Otherwise it is fetched from the phone and set by an
+ * APP_EVENT_BLE_ANCS_BODY event, reported as an update of @p index.
+ * @return The message, NULL while it is being fetched, "" if unavailable;
+ * valid until the next model call.
+ */
+const char* model_get_message(uint8_t index);
+
+/**
+ * @brief Keep a fetched message for the notification with its UID.
+ */
+void model_set_message(const ancs_noti_body_t* msg);
+
 void model_dump_notifications(void);
-void modes_handle_timeout(void);
+
+/* Takes APP_EVENT_BLE_ANCS and APP_EVENT_BLE_ANCS_BODY payloads into the model, follows the ANCS sessions */
+extern bus_subscriber_t model_subscriber;
 
 #endif  // APP_MODEL_H
@@ -5,6 +5,8 @@
 
 #include "../driver/LPM013M126A.h"
 #include "../event.h"
+#include "../hal/ble.h"
+#include "../hal/conn_params.h"
 
 LOG_MODULE_REGISTER(modes, LOG_LEVEL_INF);
 
@@ -26,6 +28,7 @@ void modes_init(void) {
   // Start in active mode
   current_mode = APP_MODE_ACTIVE;
   cmlcd_backlight_set(active_brightness);
+  conn_params_demand(CONN_DEMAND_USER, true);
   k_timer_start(&mode_timer, K_MSEC(MODE_TIMEOUT_MS), K_NO_WAIT);
   LOG_INF("Modes initialized, default brightness: %d%%", active_brightness);
 }
@@ -35,7 +38,10 @@ void modes_activity_detected(void) {
     LOG_INF("Activity detected: Entering ACTIVE mode");
     current_mode = APP_MODE_ACTIVE;
     cmlcd_backlight_set(active_brightness);
+    conn_params_demand(CONN_DEMAND_USER, true);
   }
+  // A phone may be looking for the watch: advertise fast again
+  ble_adv_wake();
   // Reset timer
   k_timer_start(&mode_timer, K_MSEC(MODE_TIMEOUT_MS), K_NO_WAIT);
 }
@@ -51,10 +57,27 @@ void modes_set_active_brightness(uint8_t brightness) {
 
 uint8_t modes_get_active_brightness(void) { return active_brightness; }
 
-void modes_handle_timeout(void) {
+app_mode_t modes_get_mode(void) { return current_mode; }
+
+static void modes_handle_timeout(void) {
   if (current_mode == APP_MODE_ACTIVE) {
     LOG_INF("Timeout reached: Entering AMBIENT mode");
     current_mode = APP_MODE_AMBIENT;
     cmlcd_backlight_set(0);
+    conn_params_demand(CONN_DEMAND_USER, false);
   }
 }
+
+static void modes_handle_event(app_event_t* event) {
+  if (event->type == APP_EVENT_BUTTON) {
+    modes_activity_detected();
+  } else {
+    modes_handle_timeout();
+  }
+}
+
+bus_subscriber_t modes_subscriber = {
+    .name = "modes",
+    .event_mask = BUS_ON(APP_EVENT_BUTTON) | BUS_ON(APP_EVENT_MODE_TIMEOUT),
+    .handle_event = modes_handle_event,
+};
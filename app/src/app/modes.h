@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 
+#include "bus.h"
+
 typedef enum {
   APP_MODE_AMBIENT,
   APP_MODE_ACTIVE,
@@ -28,4 +30,12 @@ void modes_set_active_brightness(uint8_t brightness);
  */
 uint8_t modes_get_active_brightness(void);
 
+/**
+ * @brief Get the current power mode.
+ */
+app_mode_t modes_get_mode(void);
+
+/* Restarts the timeout on buttons and enters AMBIENT when it expires */
+extern bus_subscriber_t modes_subscriber;
+
 #endif /* MODES_H */
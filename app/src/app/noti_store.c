@@ -0,0 +1,117 @@
+#include "noti_store.h"
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/fs/nvs.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+
+LOG_MODULE_REGISTER(noti_store, LOG_LEVEL_INF);
+
+#if defined(CONFIG_NVS) && FIXED_PARTITION_EXISTS(noti_partition)
+
+/* NVS IDs: the index record, then a head and a body ID per slot */
+#define NOTI_STORE_ID_INDEX 1
+#define NOTI_STORE_ID_HEAD(seq) (2 + 2 * ((seq) % NOTI_STORE_SLOTS))
+#define NOTI_STORE_ID_BODY(seq) (NOTI_STORE_ID_HEAD(seq) + 1)
+
+static struct nvs_fs fs;
+static bool mounted;
+
+int noti_store_init(struct noti_store_index* index) {
+  struct flash_pages_info info;
+  int err;
+
+  fs.flash_device = FIXED_PARTITION_DEVICE(noti_partition);
+  if (!device_is_ready(fs.flash_device)) {
+    return -ENODEV;
+  }
+  fs.offset = FIXED_PARTITION_OFFSET(noti_partition);
+  err = flash_get_page_info_by_offs(fs.flash_device, fs.offset, &info);
+  if (err) {
+    return err;
+  }
+  fs.sector_size = info.size;
+  fs.sector_count = FIXED_PARTITION_SIZE(noti_partition) / info.size;
+  err = nvs_mount(&fs);
+  if (err) {
+    LOG_ERR("Mount failed: %d", err);
+    return err;
+  }
+  mounted = true;
+
+  if (nvs_read(&fs, NOTI_STORE_ID_INDEX, index, sizeof(*index)) != sizeof(*index)) {
+    memset(index, 0, sizeof(*index));
+  }
+  LOG_INF("%u notifications stored, %d B free", __builtin_popcountll(index->live), (int)nvs_calc_free_space(&fs));
+  return 0;
+}
+
+int noti_store_set_index(const struct noti_store_index* index) {
+  if (!mounted) {
+    return -ENODEV;
+  }
+  // NVS skips the write when the value did not change
+  ssize_t ret = nvs_write(&fs, NOTI_STORE_ID_INDEX, index, sizeof(*index));
+  return ret < 0 ? ret : 0;
+}
+
+int noti_store_write(uint32_t seq, const void* head, size_t head_len, const void* body, size_t body_len) {
+  ssize_t ret;
+
+  if (!mounted) {
+    return -ENODEV;
+  }
+  ret = body ? nvs_write(&fs, NOTI_STORE_ID_BODY(seq), body, body_len) : 0;
+  if (ret >= 0) {
+    // The head goes last: a slot whose head matches is complete
+    ret = nvs_write(&fs, NOTI_STORE_ID_HEAD(seq), head, head_len);
+  }
+  return ret < 0 ? ret : 0;
+}
+
+int noti_store_write_body(uint32_t seq, const void* body, size_t body_len) {
+  if (!mounted) {
+    return -ENODEV;
+  }
+  // NVS deletes the entry on a zero-length write
+  ssize_t ret = nvs_write(&fs, NOTI_STORE_ID_BODY(seq), body, body_len);
+  return ret < 0 ? ret : 0;
+}
+
+void noti_store_delete(uint32_t seq) {
+  if (mounted) {
+    nvs_delete(&fs, NOTI_STORE_ID_HEAD(seq));
+    nvs_delete(&fs, NOTI_STORE_ID_BODY(seq));
+  }
+}
+
+ssize_t noti_store_read_head(uint32_t seq, void* buf, size_t len) {
+  return mounted ? nvs_read(&fs, NOTI_STORE_ID_HEAD(seq), buf, len) : -ENODEV;
+}
+
+ssize_t noti_store_read_body(uint32_t seq, void* buf, size_t len) {
+  return mounted ? nvs_read(&fs, NOTI_STORE_ID_BODY(seq), buf, len) : -ENODEV;
+}
+
+#else
+
+int noti_store_init(struct noti_store_index* index) { return -ENODEV; }
+
+int noti_store_set_index(const struct noti_store_index* index) { return -ENODEV; }
+
+int noti_store_write(uint32_t seq, const void* head, size_t head_len, const void* body, size_t body_len) {
+  return -ENODEV;
+}
+
+int noti_store_write_body(uint32_t seq, const void* body, size_t body_len) { return -ENODEV; }
+
+void noti_store_delete(uint32_t seq) {}
+
+ssize_t noti_store_read_head(uint32_t seq, void* buf, size_t len) { return -ENODEV; }
+
+ssize_t noti_store_read_body(uint32_t seq, void* buf, size_t len) { return -ENODEV; }
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef APP_NOTI_STORE_H
+#define APP_NOTI_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+ * Notifications in flash: NVS records in noti_partition, keyed by a sequence
+ * number that wraps over NOTI_STORE_SLOTS. Each notification is a small head
+ * record (app, title) and a separate body record (message), so listing
+ * notifications never reads the bodies. All functions return -ENODEV on
+ * boards without the partition.
+ */
+#define NOTI_STORE_SLOTS 64
+
+/* Which slots hold a listed notification */
+struct noti_store_index {
+  uint32_t next;  // sequence number of the next notification
+  uint32_t reserved;
+  uint64_t live;  // bit k: notification next - 1 - k
+};
+
+/**
+ * @brief Mount the partition and read the index. Only the index record is
+ * read, whatever the number of notifications.
+ */
+int noti_store_init(struct noti_store_index* index);
+
+int noti_store_set_index(const struct noti_store_index* index);
+
+/**
+ * @brief Write the head of a notification, after its body unless @p body is
+ * NULL.
+ */
+int noti_store_write(uint32_t seq, const void* head, size_t head_len, const void* body, size_t body_len);
+
+/**
+ * @brief Replace the body of a stored notification; an empty one deletes it.
+ */
+int noti_store_write_body(uint32_t seq, const void* body, size_t body_len);
+
+void noti_store_delete(uint32_t seq);
+
+/** @return Bytes read, or a negative error. */
+ssize_t noti_store_read_head(uint32_t seq, void* buf, size_t len);
+ssize_t noti_store_read_body(uint32_t seq, void* buf, size_t len);
+
+#endif  // APP_NOTI_STORE_H
@@ -4,11 +4,15 @@
 #include <stdint.h>
 
 #include "../event.h"
+#include "bus.h"
 
 typedef struct screen {
+  const char* name;
+  uint32_t event_mask;  // BUS_ON() of the event types handle_event() is given while shown
   void (*init)(void);
   void (*handle_event)(app_event_t* event);
   void (*load)(void);
+  void (*unload)(void);  // optional, called when another screen is loaded
 } screen_t;
 
 #endif  // APP_SCREEN_H
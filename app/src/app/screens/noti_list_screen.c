@@ -0,0 +1,136 @@
+#include "noti_list_screen.h"
+
+#include <lvgl.h>
+#include <zephyr/logging/log.h>
+
+#include "../../ui/ui.h"
+#include "../app.h"
+#include "../model.h"
+#include "../vlist.h"
+#include "noti_screen.h"
+#include "watchface_screen.h"
+
+LOG_MODULE_DECLARE(ui_module);
+
+#define LIST_HEADER_HEIGHT 24
+#define LIST_ROW_HEIGHT 30
+#define LIST_VISIBLE_ROWS 5
+
+static lv_obj_t* list_screen;
+static lv_obj_t* list_header;
+static vlist_t list;
+
+static void noti_list_bind(lv_obj_t* row, uint16_t index, bool selected) {
+  model_noti_t info;
+
+  lv_label_set_text(row, model_get_notification(index, &info) ? info.title : "");
+  lv_obj_set_style_bg_opa(row, selected ? LV_OPA_COVER : LV_OPA_TRANSP, 0);
+  lv_obj_set_style_text_color(row, selected ? lv_color_white() : lv_color_black(), 0);
+}
+
+static void noti_list_update_header(void) {
+  uint8_t count = model_get_notification_count();
+
+  if (count == 0) {
+    lv_label_set_text(list_header, "No Notifications");
+  } else {
+    lv_label_set_text_fmt(list_header, "Notifications (%u)", count);
+  }
+}
+
+static void noti_list_update(void) {
+  noti_list_update_header();
+  vlist_set_count(&list, model_get_notification_count());
+}
+
+/* Rebind only the rows the last model change touched */
+static void noti_list_apply_change(void) {
+  const model_change_t* change = model_last_change();
+
+  if (change->reset) {
+    noti_list_update();
+    return;
+  }
+  if (change->updated >= 0) {
+    vlist_update_item(&list, change->updated);
+  }
+  if (change->removed >= 0) {
+    vlist_remove_item(&list, change->removed);
+    noti_list_update_header();
+  }
+  if (change->added) {
+    // Newest notification goes on top, every visible row shifts by one
+    noti_list_update();
+  }
+}
+
+static void noti_list_handle_button(app_event_t* event) {
+  uint32_t button_idx = event->value;
+
+  switch (button_idx) {
+    case 0:
+      vlist_move(&list, -1);
+      break;
+    case 1:
+      if (model_get_notification_count() > 0) {
+        noti_screen_set_index((uint8_t)vlist_selected(&list));
+        app_switch_screen(&noti_screen);
+      }
+      break;
+    case 2:
+      vlist_move(&list, 1);
+      break;
+    case 3:
+      app_switch_screen(&watchface_screen);
+      break;
+    default:
+      break;
+  }
+}
+
+static void noti_list_init(void) {
+  list_screen = lv_obj_create(NULL);
+  lv_obj_remove_flag(list_screen, LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_set_style_pad_all(list_screen, 0, 0);
+
+  list_header = lv_label_create(list_screen);
+  lv_obj_set_pos(list_header, 4, 2);
+  lv_obj_set_style_text_font(list_header, &lv_font_montserrat_14, 0);
+  lv_obj_set_style_text_color(list_header, lv_color_hex(0x0000FF), 0);
+
+  vlist_init(&list, list_screen, LIST_HEADER_HEIGHT, LIST_ROW_HEIGHT, LIST_VISIBLE_ROWS, noti_list_bind);
+  for (uint8_t i = 0; i < list.row_count; i++) {
+    lv_obj_set_style_text_font(list.rows[i], &ui_font_NotoSansCondensedMedium, 0);
+    lv_obj_set_style_bg_color(list.rows[i], lv_color_hex(0x0000FF), 0);
+    lv_obj_set_style_pad_left(list.rows[i], 4, 0);
+  }
+}
+
+static void noti_list_load(void) {
+  lv_screen_load(list_screen);
+  noti_list_update();
+}
+
+static void noti_list_handle_event(app_event_t* event) {
+  switch (event->type) {
+    case APP_EVENT_BUTTON:
+      noti_list_handle_button(event);
+      break;
+    case APP_EVENT_BLE_ANCS:
+    case APP_EVENT_BLE_ANCS_REMOVED:
+    case APP_EVENT_BLE_ANCS_SYNCED:
+      noti_list_apply_change();
+      break;
+    default:
+      break;
+  }
+}
+
+screen_t noti_list_screen = {
+    .name = "noti_list",
+    .init = noti_list_init,
+    .event_mask = BUS_ON(APP_EVENT_BUTTON) | BUS_ON(APP_EVENT_BLE_ANCS) | BUS_ON(APP_EVENT_BLE_ANCS_REMOVED) |
+                  BUS_ON(APP_EVENT_BLE_ANCS_SYNCED),
+    .handle_event = noti_list_handle_event,
+    .load = noti_list_load,
+};
@@ -0,0 +1,8 @@
+#ifndef NOTI_LIST_SCREEN_H
+#define NOTI_LIST_SCREEN_H
+
+#include "../screen.h"
+
+extern screen_t noti_list_screen;
+
+#endif  // NOTI_LIST_SCREEN_H
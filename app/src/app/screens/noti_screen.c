@@ -7,7 +7,7 @@
 #include "../../ui/ui.h"
 #include "../app.h"
 #include "../model.h"
-#include "watchface_screen.h"
+#include "noti_list_screen.h"
 
 LOG_MODULE_DECLARE(ui_module);
 
@@ -25,10 +25,12 @@ static void noti_display_current(void) {
     current_noti_index = 0;
   }
 
-  const ancs_noti_info_t* info = model_get_notification(current_noti_index);
-  if (info) {
-    lv_label_set_text(ui_title, info->title);
-    lv_label_set_text(ui_content, info->message);
+  model_noti_t info;
+  if (model_get_notification(current_noti_index, &info)) {
+    lv_label_set_text(ui_title, info.title);
+    // The message is fetched on first open and redrawn as an update when it arrives
+    const char* message = model_get_message(current_noti_index);
+    lv_label_set_text(ui_content, message ? message : "...");
   }
   lv_label_set_text_fmt(ui_Label3, "%d/%d", current_noti_index + 1, count);
 }
@@ -44,31 +46,68 @@ static void noti_handle_button(app_event_t* event) {
       noti_display_current();
     }
   } else if (button_idx == 3) {  // Button 3
-    app_switch_screen(&watchface_screen);
+    app_switch_screen(&noti_list_screen);
   }
 }
 
 static void noti_init(void) {}
 
 static void noti_load(void) {
-  model_dump_notifications();
   lv_screen_load(ui_Screen2);
-  current_noti_index = 0;
   noti_display_current();
 }
 
+void noti_screen_set_index(uint8_t index) { current_noti_index = index; }
+
+/* Keep showing the same notification; redraw it only if it changed or went away */
+static void noti_apply_change(void) {
+  const model_change_t* change = model_last_change();
+  bool redraw = change->updated == current_noti_index || change->reset;
+
+  if (change->removed == current_noti_index) {
+    // Gone, or modified and moved to the top, then follow it
+    redraw = true;
+    if (change->added) {
+      current_noti_index = 0;
+    }
+  } else {
+    if (change->removed >= 0 && change->removed < current_noti_index) {
+      current_noti_index--;
+    }
+    if (change->added && model_get_notification_count() == 1) {
+      redraw = true;
+    } else if (change->added) {
+      current_noti_index++;
+    }
+  }
+  if (redraw) {
+    noti_display_current();
+  } else if (model_get_notification_count() > 0) {
+    lv_label_set_text_fmt(ui_Label3, "%d/%d", current_noti_index + 1, model_get_notification_count());
+  }
+}
+
 static void noti_handle_event(app_event_t* event) {
   switch (event->type) {
     case APP_EVENT_BUTTON:
       noti_handle_button(event);
       break;
+    case APP_EVENT_BLE_ANCS:
+    case APP_EVENT_BLE_ANCS_REMOVED:
+    case APP_EVENT_BLE_ANCS_SYNCED:
+    case APP_EVENT_BLE_ANCS_BODY:
+      noti_apply_change();
+      break;
     default:
       break;
   }
 }
 
 screen_t noti_screen = {
+    .name = "noti",
     .init = noti_init,
+    .event_mask = BUS_ON(APP_EVENT_BUTTON) | BUS_ON(APP_EVENT_BLE_ANCS) | BUS_ON(APP_EVENT_BLE_ANCS_REMOVED) |
+                  BUS_ON(APP_EVENT_BLE_ANCS_SYNCED) | BUS_ON(APP_EVENT_BLE_ANCS_BODY),
     .handle_event = noti_handle_event,
     .load = noti_load,
 };
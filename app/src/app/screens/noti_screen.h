@@ -3,6 +3,14 @@
 
 #include "../screen.h"
 
+#include <stdint.h>
+
 extern screen_t noti_screen;
 
+/**
+ * @brief Select the notification shown the next time the screen is loaded.
+ * @param index 0 is the most recent notification.
+ */
+void noti_screen_set_index(uint8_t index);
+
 #endif  // NOTI_SCREEN_H
@@ -0,0 +1,271 @@
+#include "stopwatch_screen.h"
+
+#include <lvgl.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "../../driver/LPM013M126A.h"
+#include "../../ui/ui.h"
+#include "../app.h"
+#include "watchface_screen.h"
+
+LOG_MODULE_REGISTER(stopwatch_screen);
+
+#define STOPWATCH_FRAME_MS 100
+#define STOPWATCH_STATS_FRAMES 100  // log display stats every ~10 s of running
+#define TIMER_STEP_MS (60 * 1000)
+#define TIMER_MAX_MS (99 * TIMER_STEP_MS)
+
+typedef enum {
+  STOPWATCH_MODE_STOPWATCH,
+  STOPWATCH_MODE_TIMER,
+} stopwatch_mode_t;
+
+/*
+ * Elapsed time is derived from the kernel uptime counter, never accumulated
+ * per frame: a late or dropped frame only delays the redraw, it never loses
+ * time. The frame timer just decides when to look at the counter.
+ */
+static struct {
+  stopwatch_mode_t mode;
+  bool running;
+  int64_t started_at;  // k_uptime_ticks() at the last start
+  int64_t banked;      // ticks accumulated before the last start
+  uint32_t timer_ms;   // countdown length
+} sw;
+
+static struct {
+  uint32_t frames;
+  uint32_t skipped;  // frames where more than one tenth passed since the last one
+  uint32_t rows;
+  uint32_t us;
+  int32_t last_tenths;
+  struct cmlcd_stats lcd;
+} frame_stats;
+
+static struct k_timer frame_timer;
+
+static lv_obj_t* sw_screen;
+static lv_obj_t* mode_label;
+static lv_obj_t* main_label;    // "MM:SS", changes once a second
+static lv_obj_t* tenths_label;  // ".T", the only object touched at 10 Hz
+static lv_obj_t* hint_label;
+
+static void frame_timer_cb(struct k_timer* timer) {
+  app_event_t event = {
+      .type = APP_EVENT_STOPWATCH_TICK,
+  };
+  event_post(&event);
+}
+
+static uint32_t stopwatch_elapsed_ms(void) {
+  int64_t ticks = sw.banked;
+
+  if (sw.running) {
+    ticks += k_uptime_ticks() - sw.started_at;
+  }
+  return (uint32_t)k_ticks_to_ms_floor64(ticks);
+}
+
+/* Milliseconds to show: elapsed for the stopwatch, remaining for the timer */
+static uint32_t stopwatch_shown_ms(void) {
+  uint32_t elapsed = stopwatch_elapsed_ms();
+
+  if (sw.mode == STOPWATCH_MODE_STOPWATCH) {
+    return elapsed;
+  }
+  // Round up so the timer reads 00:00.0 only once it has expired
+  return elapsed >= sw.timer_ms ? 0 : sw.timer_ms - elapsed + 99;
+}
+
+static void stopwatch_set_running(bool run) {
+  if (run == sw.running) {
+    return;
+  }
+  if (run) {
+    sw.started_at = k_uptime_ticks();
+    sw.running = true;
+    frame_stats.last_tenths = -1;
+    cmlcd_stats_get(&frame_stats.lcd);
+    k_timer_start(&frame_timer, K_MSEC(STOPWATCH_FRAME_MS), K_MSEC(STOPWATCH_FRAME_MS));
+  } else {
+    k_timer_stop(&frame_timer);
+    sw.banked += k_uptime_ticks() - sw.started_at;
+    sw.running = false;
+  }
+}
+
+static void stopwatch_reset(void) {
+  stopwatch_set_running(false);
+  sw.banked = 0;
+}
+
+static void stopwatch_frame_stats(int32_t tenths) {
+  struct cmlcd_stats lcd;
+
+  cmlcd_stats_get(&lcd);
+  if (lcd.refreshes != frame_stats.lcd.refreshes) {
+    frame_stats.us += lcd.last_us;
+  }
+  frame_stats.rows += lcd.rows - frame_stats.lcd.rows;
+  frame_stats.lcd = lcd;
+
+  if (frame_stats.last_tenths >= 0 && (tenths - frame_stats.last_tenths > 1 || frame_stats.last_tenths - tenths > 1)) {
+    frame_stats.skipped++;
+  }
+  frame_stats.last_tenths = tenths;
+
+  if (++frame_stats.frames == STOPWATCH_STATS_FRAMES) {
+    LOG_INF("%u frames, %u skipped, avg %u rows / %u us SPI per frame", frame_stats.frames, frame_stats.skipped,
+            frame_stats.rows / frame_stats.frames, frame_stats.us / frame_stats.frames);
+    frame_stats.frames = 0;
+    frame_stats.skipped = 0;
+    frame_stats.rows = 0;
+    frame_stats.us = 0;
+  }
+}
+
+static void stopwatch_update(void) {
+  uint32_t ms = stopwatch_shown_ms();
+  uint32_t tenths = ms / 100;
+  uint32_t seconds = tenths / 10;
+  static uint32_t shown_seconds = UINT32_MAX;
+
+  // lv_label_set_text invalidates even for identical text, so only touch
+  // the minutes/seconds label when it really changes
+  if (seconds != shown_seconds) {
+    lv_label_set_text_fmt(main_label, "%02u:%02u", (seconds / 60) % 100, seconds % 60);
+    shown_seconds = seconds;
+  }
+  lv_label_set_text_fmt(tenths_label, ".%u", tenths % 10);
+
+  if (sw.running) {
+    stopwatch_frame_stats(tenths);
+  }
+}
+
+static void stopwatch_update_labels(void) {
+  lv_label_set_text(mode_label, sw.mode == STOPWATCH_MODE_STOPWATCH ? "Stopwatch" : "Timer");
+  if (sw.running) {
+    lv_label_set_text(hint_label, "0 pause");
+  } else if (sw.banked > 0) {
+    lv_label_set_text(hint_label, "0 resume  2 reset");
+  } else if (sw.mode == STOPWATCH_MODE_TIMER) {
+    lv_label_set_text(hint_label, "0 start  2 +1 min  1 mode");
+  } else {
+    lv_label_set_text(hint_label, "0 start  1 mode");
+  }
+  stopwatch_update();
+}
+
+static void stopwatch_handle_tick(void) {
+  if (sw.mode == STOPWATCH_MODE_TIMER && sw.running && stopwatch_elapsed_ms() >= sw.timer_ms) {
+    LOG_INF("Timer expired");
+    stopwatch_set_running(false);
+    sw.banked = 0;
+    stopwatch_update_labels();
+    return;
+  }
+  stopwatch_update();
+}
+
+static void stopwatch_handle_button(app_event_t* event) {
+  uint32_t button_idx = event->value;
+
+  switch (button_idx) {
+    case 0:
+      // Button 0: start / pause
+      if (sw.mode == STOPWATCH_MODE_TIMER && sw.timer_ms == 0) {
+        break;
+      }
+      stopwatch_set_running(!sw.running);
+      break;
+    case 1:
+      // Button 1: switch between stopwatch and timer while idle
+      if (!sw.running && sw.banked == 0) {
+        sw.mode = sw.mode == STOPWATCH_MODE_STOPWATCH ? STOPWATCH_MODE_TIMER : STOPWATCH_MODE_STOPWATCH;
+      }
+      break;
+    case 2:
+      // Button 2: reset when paused, otherwise add a minute to the timer
+      if (sw.running) {
+        break;
+      }
+      if (sw.banked > 0) {
+        stopwatch_reset();
+      } else if (sw.mode == STOPWATCH_MODE_TIMER) {
+        sw.timer_ms = sw.timer_ms >= TIMER_MAX_MS ? 0 : sw.timer_ms + TIMER_STEP_MS;
+      }
+      break;
+    case 3:
+      // Button 3: back to the watchface, a running stopwatch keeps counting
+      app_switch_screen(&watchface_screen);
+      return;
+    default:
+      break;
+  }
+  stopwatch_update_labels();
+}
+
+static void stopwatch_init(void) {
+  k_timer_init(&frame_timer, frame_timer_cb, NULL);
+
+  sw_screen = lv_obj_create(NULL);
+  lv_obj_remove_flag(sw_screen, LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_set_style_pad_all(sw_screen, 0, 0);
+
+  mode_label = lv_label_create(sw_screen);
+  lv_obj_set_style_text_font(mode_label, &lv_font_montserrat_14, 0);
+  lv_obj_set_style_text_color(mode_label, lv_color_hex(0x0000FF), 0);
+  lv_obj_align(mode_label, LV_ALIGN_TOP_MID, 0, 8);
+
+  // Fixed-size labels so a digit change never moves or resizes anything else
+  main_label = lv_label_create(sw_screen);
+  lv_obj_set_style_text_font(main_label, &ui_font_sevensegments, 0);
+  lv_obj_set_pos(main_label, 8, 60);
+
+  tenths_label = lv_label_create(sw_screen);
+  lv_obj_set_style_text_font(tenths_label, &lv_font_montserrat_30, 0);
+  lv_obj_set_pos(tenths_label, 136, 76);
+
+  hint_label = lv_label_create(sw_screen);
+  lv_obj_set_style_text_font(hint_label, &lv_font_montserrat_14, 0);
+  lv_obj_align(hint_label, LV_ALIGN_BOTTOM_MID, 0, -8);
+}
+
+static void stopwatch_load(void) {
+  lv_screen_load(sw_screen);
+  if (sw.running) {
+    // A countdown may have run out while another screen was shown
+    k_timer_start(&frame_timer, K_MSEC(STOPWATCH_FRAME_MS), K_MSEC(STOPWATCH_FRAME_MS));
+    stopwatch_handle_tick();
+  }
+  stopwatch_update_labels();
+}
+
+static void stopwatch_unload(void) {
+  // Only the redraws stop; elapsed time still comes from the uptime counter
+  k_timer_stop(&frame_timer);
+}
+
+static void stopwatch_handle_event(app_event_t* event) {
+  switch (event->type) {
+    case APP_EVENT_BUTTON:
+      stopwatch_handle_button(event);
+      break;
+    case APP_EVENT_STOPWATCH_TICK:
+      stopwatch_handle_tick();
+      break;
+    default:
+      break;
+  }
+}
+
+screen_t stopwatch_screen = {
+    .name = "stopwatch",
+    .init = stopwatch_init,
+    .event_mask = BUS_ON(APP_EVENT_BUTTON) | BUS_ON(APP_EVENT_STOPWATCH_TICK),
+    .handle_event = stopwatch_handle_event,
+    .load = stopwatch_load,
+    .unload = stopwatch_unload,
+};
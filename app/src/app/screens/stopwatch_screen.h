@@ -0,0 +1,8 @@
+#ifndef STOPWATCH_SCREEN_H
+#define STOPWATCH_SCREEN_H
+
+#include "../screen.h"
+
+extern screen_t stopwatch_screen;
+
+#endif  // STOPWATCH_SCREEN_H
@@ -3,85 +3,168 @@
 #include <lvgl.h>
 #include <zephyr/logging/log.h>
 
+#include "../../driver/LPM013M126A.h"
 #include "../../hal/rtc.h"
 #include "../app.h"
-#include "../model.h"
 #include "../modes.h"
-#include "../ui/ui.h"
-#include "noti_screen.h"
+#include "../watchface.h"
+#include "noti_list_screen.h"
+#include "stopwatch_screen.h"
 
 LOG_MODULE_REGISTER(watchface_screen);
 
-static void watchface_handle_rtc_alarm(app_event_t* event) {
-  (void)event;
-  struct rtc_time time;
-  static const char* months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+/*
+ * Budget for the 1 Hz seconds path. The seconds band is 17 panel lines:
+ * 17 * 92 B = 1564 B, ~12.5 ms at the 1 MHz panel SPI clock, versus ~130 ms
+ * for a full frame. Measured SPI time per second is logged every minute.
+ */
+#define SECONDS_BUDGET_US 20000
+
+static const watchface_t* face;
+static uint8_t face_index = 0;
+static watchface_ctx_t ctx;
+static bool face_has_seconds;
+static bool seconds_running;
+
+/* Panel transfer spent per second while the seconds ticker runs */
+static struct cmlcd_stats tick_stats;
+static uint32_t tick_count;
+static uint32_t tick_us_total;
+static uint32_t tick_rows_total;
+
+/* Time each complication was last drawn at, to honour its cadence */
+static struct rtc_time drawn_at[WATCHFACE_MAX_COMPLICATIONS];
+
+static bool cadence_due(watchface_cadence_t cadence, const struct rtc_time* last, const struct rtc_time* now) {
+  bool day = last->tm_mday != now->tm_mday || last->tm_mon != now->tm_mon || last->tm_year != now->tm_year;
+
+  switch (cadence) {
+    case WATCHFACE_CADENCE_DAY:
+      return day;
+    case WATCHFACE_CADENCE_HOUR:
+      return day || last->tm_hour != now->tm_hour;
+    case WATCHFACE_CADENCE_MINUTE:
+      return day || last->tm_hour != now->tm_hour || last->tm_min != now->tm_min;
+    default:
+      return true;
+  }
+}
+
+static void seconds_measure(void) {
+  struct cmlcd_stats now;
+
+  cmlcd_stats_get(&now);
+  uint32_t rows = now.rows - tick_stats.rows;
+  // Only last_us is per refresh; with one refresh per tick it is the tick's cost
+  uint32_t us = (now.refreshes != tick_stats.refreshes) ? now.last_us : 0;
+  tick_stats = now;
+
+  tick_rows_total += rows;
+  tick_us_total += us;
+  if (us > SECONDS_BUDGET_US) {
+    LOG_WRN("Seconds tick over budget: %u us, %u rows", us, rows);
+  }
+  if (++tick_count == 60) {
+    LOG_INF("Seconds: avg %u us, %u rows (%u B) SPI per tick", tick_us_total / tick_count, tick_rows_total / tick_count,
+            tick_rows_total * LCD_LINE_XFER_BYTES / tick_count);
+    tick_count = 0;
+    tick_us_total = 0;
+    tick_rows_total = 0;
+  }
+}
+
+static bool complication_ready(const complication_t* c) {
+  if ((c->triggers & WATCHFACE_ON(APP_EVENT_RTC_ALARM)) && !ctx.has_time) {
+    return false;
+  }
+  if ((c->triggers & WATCHFACE_ON(APP_EVENT_BATTERY)) && !ctx.has_battery) {
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Run the complications that @p event makes stale, or all of them when
+ * @p event is NULL. Only the objects they touch are invalidated, so LVGL
+ * redraws and the panel transfers just their row bands.
+ */
+static void watchface_schedule(const app_event_t* event) {
+  uint32_t mask = event ? WATCHFACE_ON(event->type) : UINT32_MAX;
+
+  ctx.event = event;
+  if (event && event->type == APP_EVENT_RTC_SECOND) {
+    seconds_measure();
+    ctx.now.tm_sec = event->value;
+  } else if (mask & WATCHFACE_ON(APP_EVENT_RTC_ALARM)) {
+    ctx.has_time = rtc_time_get(&ctx.now) == 0;
+    if (!ctx.has_time) {
+      LOG_ERR("Failed to get RTC time");
+    }
+  }
+  if (event && event->type == APP_EVENT_BATTERY) {
+    ctx.battery = event->value;
+    ctx.has_battery = true;
+  }
+
+  for (uint8_t i = 0; i < face->complication_count; i++) {
+    const complication_t* c = &face->complications[i];
+
+    if (!(c->triggers & mask) || !complication_ready(c)) {
+      continue;
+    }
+    if (event && event->type == APP_EVENT_RTC_ALARM && !cadence_due(c->cadence, &drawn_at[i], &ctx.now)) {
+      continue;
+    }
+
+    c->update(&ctx);
+    if (ctx.has_time) {
+      drawn_at[i] = ctx.now;
+    }
+  }
+}
 
-  if (rtc_time_get(&time) != 0) {
-    LOG_ERR("Failed to get RTC time");
+/* Run or stop the 1 Hz ticker; second-cadence complications hide while it is stopped */
+static void seconds_set_running(bool run) {
+  run = run && face_has_seconds;
+  if (run == seconds_running) {
     return;
   }
+  if (rtc_second_tick_enable(run) < 0) {
+    LOG_ERR("Failed to %s seconds ticker", run ? "start" : "stop");
+    return;
+  }
+  seconds_running = run;
+  cmlcd_stats_get(&tick_stats);
 
-  lv_label_set_text_fmt(ui_HourLabel, "%02d", time.tm_hour);
-  lv_label_set_text_fmt(ui_MinuteLabel, "%02d", time.tm_min);
-  lv_label_set_text_fmt(ui_Label6, "%s %d, %d", months[time.tm_mon], time.tm_mday, time.tm_year + 1900);
-
-  // Set AM/PM icon
-  if (time.tm_hour < 12) {
-    lv_img_set_src(ui_Image2, &ui_img_sun_png);
-  } else {
-    lv_img_set_src(ui_Image2, &ui_img_moon_png);
-  }
-
-  // Date row update only
-  static lv_obj_t** const date_labels[7] = {&ui_day1, &ui_day2, &ui_day3, &ui_day4, &ui_day5, &ui_day6, &ui_day7};
-  // tm_wday: 0=Sun, 6=Sat; shift to 0=Mon
-  int wday = time.tm_wday == 0 ? 6 : time.tm_wday - 1;
-  int today = time.tm_mday;
-  struct rtc_time t = time;
-  int delta = wday;
-  t.tm_mday -= delta;
-  for (int i = 0; i < 7; ++i) {
-    int d = t.tm_mday + i;
-    lv_label_set_text_fmt(*date_labels[i], "%02d", d);
-    // Highlight current day with round rect border only, not filled
-    if (d == today) {
-      lv_obj_set_style_border_color(*date_labels[i], lv_color_black(), 0);
-      lv_obj_set_style_border_width(*date_labels[i], 2, 0);
-      // Rectangle border
-      lv_obj_set_style_radius(*date_labels[i], 1, 0);
-    } else {
-      lv_obj_set_style_border_width(*date_labels[i], 0, 0);
+  ctx.event = NULL;
+  ctx.ambient = !run;
+  if (run) {
+    ctx.has_time = rtc_time_get(&ctx.now) == 0;
+  }
+  for (uint8_t i = 0; i < face->complication_count; i++) {
+    const complication_t* c = &face->complications[i];
+    if (c->cadence == WATCHFACE_CADENCE_SECOND && complication_ready(c)) {
+      c->update(&ctx);
     }
   }
 }
 
-static void watchface_handle_battery(app_event_t* event) {
-  uint32_t value = event->value;
-  uint8_t percent = value & 0xFF;
-  bool is_charging = (value >> 8) & 0x01;
-
-  int battery_index = percent / 20;
-  if (battery_index > 5) {
-    battery_index = 5;
-  }
-  const static lv_image_dsc_t* battery_icons[] = {
-      &ui_img_battery_status_0_png,  // empty
-      &ui_img_battery_status_1_png,  // 20%
-      &ui_img_battery_status_2_png,  // 40%
-      &ui_img_battery_status_3_png,  // 60%
-      &ui_img_battery_status_4_png,  // 80%
-      &ui_img_battery_status_5_png,  // full
-  };
-  LOG_INF("Battery percent: %u, charging: %d, index: %d", percent, is_charging, battery_index);
-  lv_img_set_src(ui_batteryIcon, battery_icons[battery_index]);
-  lv_label_set_text_fmt(ui_Label5, "%u%%", percent);
-
-  if (is_charging) {
-    lv_obj_remove_flag(ui_Image3, LV_OBJ_FLAG_HIDDEN);
-  } else {
-    lv_obj_add_flag(ui_Image3, LV_OBJ_FLAG_HIDDEN);
+static void watchface_show(uint8_t index) {
+  seconds_set_running(false);
+
+  face_index = index;
+  face = watchfaces[face_index];
+  face_has_seconds = false;
+  for (uint8_t i = 0; i < face->complication_count; i++) {
+    if (face->complications[i].cadence == WATCHFACE_CADENCE_SECOND) {
+      face_has_seconds = true;
+    }
   }
+
+  lv_screen_load(face->screen());
+  ctx.ambient = modes_get_mode() == APP_MODE_AMBIENT;
+  watchface_schedule(NULL);
+  seconds_set_running(!ctx.ambient);
 }
 
 static void watchface_handle_button(app_event_t* event) {
@@ -97,8 +180,8 @@ static void watchface_handle_button(app_event_t* event) {
       break;
     }
     case 1:
-      // Button 1: Switch to notification screen
-      app_switch_screen(&noti_screen);
+      // Button 1: Switch to notification list
+      app_switch_screen(&noti_list_screen);
       break;
     case 2: {
       uint8_t brightness = modes_get_active_brightness();
@@ -108,6 +191,15 @@ static void watchface_handle_button(app_event_t* event) {
       modes_set_active_brightness(brightness);
       break;
     }
+    case 3:
+      // Button 3: Next watchface, then the stopwatch after the last one
+      if (face_index + 1 < watchface_count) {
+        watchface_show(face_index + 1);
+      } else {
+        face_index = 0;
+        app_switch_screen(&stopwatch_screen);
+      }
+      break;
     default:
       LOG_WRN("Unhandled button index: %d", button_idx);
       break;
@@ -115,40 +207,42 @@ static void watchface_handle_button(app_event_t* event) {
 }
 
 static void watchface_init(void) {
-  // ui_Screen1_screen_init() is already called in ui_init()
-  lv_label_set_text_fmt(ui_numNoti, "%u", model_get_notification_count());
+  for (uint8_t i = 0; i < watchface_count; i++) {
+    if (watchfaces[i]->init) {
+      watchfaces[i]->init();
+    }
+  }
+  face = watchfaces[face_index];
 }
 
-static void watchface_load(void) {
-  lv_screen_load(ui_Screen1);
-  // Trigger initial update
-  watchface_handle_rtc_alarm(NULL);
-}
+static void watchface_load(void) { watchface_show(face_index); }
+
+static void watchface_unload(void) { seconds_set_running(false); }
 
 static void watchface_handle_event(app_event_t* event) {
+  // The mode manager has already seen the event; whatever woke the watch, follow its mode
+  seconds_set_running(modes_get_mode() == APP_MODE_ACTIVE);
+
   switch (event->type) {
-    case APP_EVENT_RTC_ALARM:
-      watchface_handle_rtc_alarm(event);
-      break;
-    case APP_EVENT_BATTERY:
-      watchface_handle_battery(event);
-      break;
     case APP_EVENT_BUTTON:
       watchface_handle_button(event);
       break;
-    case APP_EVENT_BLE_ANCS:
-      // Update notification count
-      const uint32_t count = model_get_notification_count();
-      LOG_INF("Notification count updated: %u", count);
-      lv_label_set_text_fmt(ui_numNoti, "%u", count);
+    case APP_EVENT_MODE_TIMEOUT:
       break;
     default:
+      watchface_schedule(event);
       break;
   }
 }
 
 screen_t watchface_screen = {
+    .name = "watchface",
     .init = watchface_init,
+    // Complication triggers are a subset of these
+    .event_mask = BUS_ON(APP_EVENT_BUTTON) | BUS_ON(APP_EVENT_MODE_TIMEOUT) | BUS_ON(APP_EVENT_RTC_ALARM) |
+                  BUS_ON(APP_EVENT_RTC_SECOND) | BUS_ON(APP_EVENT_BATTERY) | BUS_ON(APP_EVENT_BLE_ANCS) |
+                  BUS_ON(APP_EVENT_BLE_ANCS_REMOVED) | BUS_ON(APP_EVENT_BLE_ANCS_SYNCED),
     .handle_event = watchface_handle_event,
     .load = watchface_load,
+    .unload = watchface_unload,
 };
@@ -0,0 +1,86 @@
+#include "snapshot.h"
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "../driver/LPM013M126A.h"
+
+LOG_MODULE_REGISTER(snapshot, LOG_LEVEL_INF);
+
+// RAM spent on cached frames, one panel-format frame is ~15.5 KB
+#define SNAPSHOT_BUDGET_BYTES (2 * LCD_FRAME_BYTES)
+#define SNAPSHOT_SLOTS (SNAPSHOT_BUDGET_BYTES / LCD_FRAME_BYTES)
+
+typedef struct {
+  const screen_t* screen;  // NULL when the slot is free
+  uint32_t last_used;
+} snapshot_slot_t;
+
+static snapshot_slot_t slots[SNAPSHOT_SLOTS];
+static uint8_t frames[SNAPSHOT_SLOTS][LCD_FRAME_BYTES] __aligned(4);
+static uint32_t use_clock = 0;
+static uint32_t hits = 0;
+static uint32_t misses = 0;
+
+static int snapshot_find(const screen_t* screen) {
+  for (int i = 0; i < SNAPSHOT_SLOTS; i++) {
+    if (slots[i].screen == screen) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static int snapshot_victim(void) {
+  int victim = 0;
+  for (int i = 0; i < SNAPSHOT_SLOTS; i++) {
+    if (slots[i].screen == NULL) {
+      return i;
+    }
+    if (slots[i].last_used < slots[victim].last_used) {
+      victim = i;
+    }
+  }
+  return victim;
+}
+
+void snapshot_save(const screen_t* screen) {
+  if (screen == NULL) {
+    return;
+  }
+
+  int idx = snapshot_find(screen);
+  if (idx < 0) {
+    idx = snapshot_victim();
+    if (slots[idx].screen) {
+      LOG_DBG("Evicting snapshot %p", slots[idx].screen);
+    }
+  }
+
+  cmlcd_frame_save(frames[idx]);
+  slots[idx].screen = screen;
+  slots[idx].last_used = ++use_clock;
+}
+
+bool snapshot_restore(const screen_t* screen) {
+  int idx = snapshot_find(screen);
+  if (idx < 0) {
+    misses++;
+    LOG_DBG("Snapshot miss %p (hits %u, misses %u)", screen, hits, misses);
+    return false;
+  }
+
+  cmlcd_frame_restore(frames[idx]);
+  slots[idx].last_used = ++use_clock;
+  hits++;
+  LOG_DBG("Snapshot hit %p (hits %u, misses %u)", screen, hits, misses);
+  return true;
+}
+
+void snapshot_invalidate(const screen_t* screen) {
+  int idx = snapshot_find(screen);
+  if (idx >= 0) {
+    slots[idx].screen = NULL;
+  }
+}
@@ -0,0 +1,25 @@
+#ifndef APP_SNAPSHOT_H
+#define APP_SNAPSHOT_H
+
+#include <stdbool.h>
+
+#include "screen.h"
+
+/**
+ * @brief Keep the panel frame that is currently shown as the snapshot of @p screen.
+ * Evicts the least recently used snapshot when the RAM budget is exhausted.
+ */
+void snapshot_save(const screen_t* screen);
+
+/**
+ * @brief Copy the cached frame of @p screen into the panel frame buffer.
+ * @return true on a cache hit; the caller should refresh the panel.
+ */
+bool snapshot_restore(const screen_t* screen);
+
+/**
+ * @brief Drop the cached frame of @p screen, if any.
+ */
+void snapshot_invalidate(const screen_t* screen);
+
+#endif  // APP_SNAPSHOT_H
@@ -0,0 +1,109 @@
+#include "toast.h"
+
+#include <lvgl.h>
+#include <zephyr/logging/log.h>
+
+#include "../ui/ui.h"
+#include "model.h"
+
+LOG_MODULE_REGISTER(toast);
+
+/* The toast covers a fixed band at the bottom of the panel */
+#define TOAST_Y 124
+#define TOAST_HEIGHT 52
+#define TOAST_WAIT_MS 1000  // longest a toast waits for the end of its burst
+#define TOAST_SHOW_MS 3000
+
+static lv_obj_t* toast;
+static lv_obj_t* app_label;
+static lv_obj_t* title_label;
+static lv_timer_t* coalesce_timer;
+static lv_timer_t* hide_timer;
+static uint8_t pending;
+
+static void toast_arm(lv_timer_t* timer) {
+  lv_timer_reset(timer);
+  lv_timer_resume(timer);
+}
+
+static void toast_show_cb(lv_timer_t* timer) {
+  model_noti_t info;
+
+  lv_timer_pause(timer);
+  if (!model_get_notification(0, &info)) {
+    pending = 0;
+    return;
+  }
+
+  if (pending > 1) {
+    lv_label_set_text_fmt(app_label, "%s  +%u", info.app, pending - 1);
+  } else {
+    lv_label_set_text(app_label, info.app);
+  }
+  lv_label_set_text(title_label, info.title);
+  LOG_DBG("Toast for %u notification(s)", pending);
+  pending = 0;
+
+  // Showing, hiding and relabelling only invalidate the toast's own band
+  lv_obj_remove_flag(toast, LV_OBJ_FLAG_HIDDEN);
+  toast_arm(hide_timer);
+}
+
+static void toast_hide_cb(lv_timer_t* timer) {
+  lv_timer_pause(timer);
+  lv_obj_add_flag(toast, LV_OBJ_FLAG_HIDDEN);
+}
+
+void toast_init(void) {
+  toast = lv_obj_create(lv_layer_top());
+  lv_obj_remove_flag(toast, LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_set_pos(toast, 0, TOAST_Y);
+  lv_obj_set_size(toast, lv_pct(100), TOAST_HEIGHT);
+  lv_obj_set_style_pad_all(toast, 4, 0);
+  lv_obj_set_style_radius(toast, 0, 0);
+  lv_obj_set_style_bg_color(toast, lv_color_white(), 0);
+  lv_obj_set_style_bg_opa(toast, LV_OPA_COVER, 0);
+  lv_obj_set_style_border_color(toast, lv_color_black(), 0);
+  lv_obj_set_style_border_width(toast, 2, 0);
+  lv_obj_set_style_border_side(toast, LV_BORDER_SIDE_TOP, 0);
+  lv_obj_add_flag(toast, LV_OBJ_FLAG_HIDDEN);
+
+  app_label = lv_label_create(toast);
+  lv_obj_set_width(app_label, lv_pct(100));
+  lv_label_set_long_mode(app_label, LV_LABEL_LONG_DOT);
+  lv_obj_set_style_text_font(app_label, &lv_font_montserrat_14, 0);
+  lv_obj_set_style_text_color(app_label, lv_color_hex(0x0000FF), 0);
+
+  title_label = lv_label_create(toast);
+  lv_obj_set_width(title_label, lv_pct(100));
+  lv_obj_set_y(title_label, 18);
+  lv_label_set_long_mode(title_label, LV_LABEL_LONG_DOT);
+  lv_obj_set_style_text_font(title_label, &ui_font_NotoSansCondensedMedium, 0);
+
+  coalesce_timer = lv_timer_create(toast_show_cb, TOAST_WAIT_MS, NULL);
+  lv_timer_pause(coalesce_timer);
+  hide_timer = lv_timer_create(toast_hide_cb, TOAST_SHOW_MS, NULL);
+  lv_timer_pause(hide_timer);
+}
+
+void toast_notify(void) {
+  // The first notification of a burst opens the window, later ones only count
+  if (pending++ == 0) {
+    toast_arm(coalesce_timer);
+  }
+}
+
+void toast_burst_end(void) {
+  if (pending > 0) {
+    toast_show_cb(coalesce_timer);
+  }
+}
+
+void toast_dismiss(void) {
+  lv_timer_pause(coalesce_timer);
+  lv_timer_pause(hide_timer);
+  pending = 0;
+  lv_obj_add_flag(toast, LV_OBJ_FLAG_HIDDEN);
+}
+
+bool toast_visible(void) { return toast != NULL && !lv_obj_has_flag(toast, LV_OBJ_FLAG_HIDDEN); }
@@ -0,0 +1,34 @@
+#ifndef APP_TOAST_H
+#define APP_TOAST_H
+
+#include <stdbool.h>
+
+/**
+ * @brief Create the toast objects on LVGL's top layer. Call after ui_init().
+ */
+void toast_init(void);
+
+/**
+ * @brief Announce that a notification was added to the model.
+ * Notifications of one burst collapse into one toast update showing the
+ * newest one and how many came with it. The toast waits for
+ * toast_burst_end(), or at most a second.
+ */
+void toast_notify(void);
+
+/**
+ * @brief Show the notifications announced so far, the burst is over.
+ */
+void toast_burst_end(void);
+
+/**
+ * @brief Remove the toast now, if shown.
+ */
+void toast_dismiss(void);
+
+/**
+ * @brief Whether the toast is drawn over the current screen.
+ */
+bool toast_visible(void);
+
+#endif  // APP_TOAST_H
@@ -0,0 +1,124 @@
+#include "vlist.h"
+
+#include <zephyr/sys/util.h>
+
+static void vlist_bind_row(vlist_t* list, uint8_t row) {
+  uint16_t index = list->top + row;
+
+  if (index >= list->item_count) {
+    lv_obj_add_flag(list->rows[row], LV_OBJ_FLAG_HIDDEN);
+    return;
+  }
+  lv_obj_remove_flag(list->rows[row], LV_OBJ_FLAG_HIDDEN);
+  list->bind(list->rows[row], index, index == list->selected);
+}
+
+static void vlist_bind_all(vlist_t* list) {
+  for (uint8_t i = 0; i < list->row_count; i++) {
+    vlist_bind_row(list, i);
+  }
+}
+
+void vlist_init(vlist_t* list, lv_obj_t* parent, int32_t y, int32_t row_h, uint8_t rows, vlist_bind_cb_t bind) {
+  if (rows > VLIST_MAX_ROWS) {
+    rows = VLIST_MAX_ROWS;
+  }
+
+  list->row_count = rows;
+  list->item_count = 0;
+  list->top = 0;
+  list->selected = 0;
+  list->bind = bind;
+
+  for (uint8_t i = 0; i < rows; i++) {
+    lv_obj_t* row = lv_label_create(parent);
+    lv_obj_set_pos(row, 0, y + i * row_h);
+    lv_obj_set_size(row, lv_pct(100), row_h);
+    lv_label_set_long_mode(row, LV_LABEL_LONG_DOT);
+    lv_obj_add_flag(row, LV_OBJ_FLAG_HIDDEN);
+    list->rows[i] = row;
+  }
+}
+
+void vlist_set_count(vlist_t* list, uint16_t count) {
+  list->item_count = count;
+
+  if (count == 0) {
+    list->top = 0;
+    list->selected = 0;
+  } else if (list->selected >= count) {
+    list->selected = count - 1;
+  }
+  if (list->top > list->selected) {
+    list->top = list->selected;
+  } else if (list->selected >= list->top + list->row_count) {
+    list->top = list->selected - list->row_count + 1;
+  }
+
+  vlist_bind_all(list);
+}
+
+void vlist_update_item(vlist_t* list, uint16_t index) {
+  if (index >= list->top && index < list->top + list->row_count) {
+    vlist_bind_row(list, index - list->top);
+  }
+}
+
+void vlist_remove_item(vlist_t* list, uint16_t index) {
+  if (index >= list->item_count) {
+    return;
+  }
+  list->item_count--;
+
+  if (index < list->top) {
+    // Same items stay in view, one position up
+    list->top--;
+    list->selected--;
+    return;
+  }
+  uint16_t first = index;
+  if (list->selected > index || (list->selected == list->item_count && list->selected > 0)) {
+    list->selected--;
+    first = MIN(first, list->selected);
+  }
+  if (list->selected < list->top) {
+    list->top = list->selected;
+    vlist_bind_all(list);
+    return;
+  }
+  for (uint16_t i = first; i < list->top + list->row_count; i++) {
+    vlist_bind_row(list, i - list->top);
+  }
+}
+
+void vlist_move(vlist_t* list, int delta) {
+  if (list->item_count == 0) {
+    return;
+  }
+
+  uint16_t old = list->selected;
+  int next = ((int)old + delta) % list->item_count;
+  if (next < 0) {
+    next += list->item_count;
+  }
+  list->selected = (uint16_t)next;
+
+  if (list->selected < list->top) {
+    list->top = list->selected;
+  } else if (list->selected >= list->top + list->row_count) {
+    list->top = list->selected - list->row_count + 1;
+  } else {
+    // Window did not move: only the two rows whose highlight changed need redrawing
+    vlist_bind_row(list, old - list->top);
+    vlist_bind_row(list, list->selected - list->top);
+    return;
+  }
+
+  vlist_bind_all(list);
+}
+
+void vlist_reset(vlist_t* list) {
+  list->top = 0;
+  list->selected = 0;
+  vlist_bind_all(list);
+}
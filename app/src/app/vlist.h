@@ -0,0 +1,62 @@
+#ifndef APP_VLIST_H
+#define APP_VLIST_H
+
+#include <lvgl.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define VLIST_MAX_ROWS 8
+
+/**
+ * @brief Fill a recycled row object with the item at @p index.
+ */
+typedef void (*vlist_bind_cb_t)(lv_obj_t* row, uint16_t index, bool selected);
+
+/**
+ * Virtualised list: a fixed pool of row objects is created once and rebound
+ * to whichever items are visible, so LVGL object count and heap use do not
+ * depend on the number of items.
+ */
+typedef struct {
+  lv_obj_t* rows[VLIST_MAX_ROWS];
+  uint8_t row_count;
+  uint16_t item_count;
+  uint16_t top;       // item shown in rows[0]
+  uint16_t selected;  // item with the selection highlight
+  vlist_bind_cb_t bind;
+} vlist_t;
+
+/**
+ * @brief Create @p rows label objects of @p row_h pixels under @p parent, starting at @p y.
+ */
+void vlist_init(vlist_t* list, lv_obj_t* parent, int32_t y, int32_t row_h, uint8_t rows, vlist_bind_cb_t bind);
+
+/**
+ * @brief Update the number of items, keep the selection in range and rebind all rows.
+ */
+void vlist_set_count(vlist_t* list, uint16_t count);
+
+/**
+ * @brief Rebind the row showing @p index, if it is visible.
+ */
+void vlist_update_item(vlist_t* list, uint16_t index);
+
+/**
+ * @brief Drop item @p index. Rows are only rebound from the removed one
+ * down, and not at all when it was outside the window.
+ */
+void vlist_remove_item(vlist_t* list, uint16_t index);
+
+/**
+ * @brief Move the selection by @p delta items (wrapping), scrolling the window as needed.
+ */
+void vlist_move(vlist_t* list, int delta);
+
+/**
+ * @brief Jump to the first item.
+ */
+void vlist_reset(vlist_t* list);
+
+static inline uint16_t vlist_selected(const vlist_t* list) { return list->selected; }
+
+#endif  // APP_VLIST_H
@@ -0,0 +1,58 @@
+#ifndef APP_WATCHFACE_H
+#define APP_WATCHFACE_H
+
+#include <lvgl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/drivers/rtc.h>
+#include <zephyr/sys/util.h>
+
+#include "../event.h"
+
+#define WATCHFACE_MAX_COMPLICATIONS 8
+
+/* Build an event mask for complication triggers */
+#define WATCHFACE_ON(type) BIT(type)
+
+/**
+ * How often a time tick really changes what a complication shows. The
+ * framework skips minute ticks that do not cross the cadence boundary.
+ */
+typedef enum {
+  WATCHFACE_CADENCE_EVENT,   // every matching event
+  WATCHFACE_CADENCE_SECOND,  // 1 Hz ticker, only runs while the face is shown in ACTIVE mode
+  WATCHFACE_CADENCE_MINUTE,
+  WATCHFACE_CADENCE_HOUR,
+  WATCHFACE_CADENCE_DAY,
+} watchface_cadence_t;
+
+/* State shared by all complications for one tick */
+typedef struct {
+  const app_event_t* event;  // NULL on a full face refresh
+  struct rtc_time now;       // tm_sec follows APP_EVENT_RTC_SECOND ticks
+  bool has_time;
+  bool ambient;      // second-cadence complications should hide themselves
+  uint32_t battery;  // last APP_EVENT_BATTERY value
+  bool has_battery;
+} watchface_ctx_t;
+
+typedef struct {
+  const char* name;
+  uint32_t triggers;  // WATCHFACE_ON() mask of events that may make it stale
+  watchface_cadence_t cadence;
+  void (*update)(const watchface_ctx_t* ctx);
+} complication_t;
+
+typedef struct {
+  const char* name;
+  void (*init)(void);         // create or bind LVGL objects, called once
+  lv_obj_t* (*screen)(void);  // root object loaded when the face is shown
+  const complication_t* complications;
+  uint8_t complication_count;
+} watchface_t;
+
+/* Registry, see app/faces/faces.c */
+extern const watchface_t* const watchfaces[];
+extern const uint8_t watchface_count;
+
+#endif  // APP_WATCHFACE_H
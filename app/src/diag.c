@@ -0,0 +1,82 @@
+#include "diag.h"
+
+#include <stdlib.h>
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+
+#include "event.h"
+
+/*
+ * Root of the "diag" shell command. Modules add their own subcommands with
+ * SHELL_SUBCMD_ADD((diag), <name>, ...) next to the state they report.
+ */
+SHELL_SUBCMD_SET_CREATE(diag_cmds, (diag));
+SHELL_CMD_REGISTER(diag, &diag_cmds, "Runtime diagnostics", NULL);
+
+#define FLOOD_DEFAULT 8
+#define FLOOD_MAX 9  // the FIFO holds 10 events, the probe takes the last one
+#define FLOOD_HANDLER_US 2000  // stand-in for the handlers of one notification
+#define FLOOD_WAIT_MS 2000
+
+/* Spends the time a notification's handlers would, without touching any state */
+static void diag_handle_event(app_event_t* event) {
+  if (event->type == APP_EVENT_DIAG_LOAD) {
+    k_busy_wait(event->value);
+  }
+}
+
+bus_subscriber_t diag_subscriber = {
+    .name = "diag",
+    .event_mask = BUS_ON(APP_EVENT_DIAG_LOAD) | BUS_ON(APP_EVENT_DIAG_INPUT),
+    .handle_event = diag_handle_event,
+};
+
+static int flood_post(app_event_type_t type, uint32_t value) {
+  app_event_t event = {
+      .type = type,
+      .value = value,
+  };
+  return event_post(&event);
+}
+
+/*
+ * Queue n loads, then an input on its lane and a probe behind the loads in
+ * the FIFO. The probe waits as long as an input did before the input lane.
+ */
+static int cmd_flood(const struct shell* sh, size_t argc, char** argv) {
+  int count = CLAMP(argc > 1 ? atoi(argv[1]) : FLOOD_DEFAULT, 0, FLOOD_MAX);
+  uint32_t handler_us = argc > 2 ? strtoul(argv[2], NULL, 10) : FLOOD_HANDLER_US;
+  struct event_stats before;
+  struct event_stats after;
+
+  event_stats_get(&before);
+  for (int i = 0; i < count; i++) {
+    if (flood_post(APP_EVENT_DIAG_LOAD, handler_us) < 0) {
+      shell_error(sh, "Event queue full");
+      return -ENOMEM;
+    }
+  }
+  if (flood_post(APP_EVENT_DIAG_INPUT, 0) < 0 || flood_post(APP_EVENT_DIAG_LOAD, 0) < 0) {
+    shell_error(sh, "Event queue full");
+    return -ENOMEM;
+  }
+
+  for (int waited = 0; waited < FLOOD_WAIT_MS; waited += 10) {
+    k_msleep(10);
+    event_stats_get(&after);
+    if (after.dispatched[APP_EVENT_DIAG_INPUT] != before.dispatched[APP_EVENT_DIAG_INPUT] &&
+        after.dispatched[APP_EVENT_DIAG_LOAD] - before.dispatched[APP_EVENT_DIAG_LOAD] == count + 1) {
+      shell_print(sh, "%d loads of %u us", count, handler_us);
+      shell_print(sh, "input lane: %u us, %u events ahead", after.latency_last_us[APP_EVENT_DIAG_INPUT],
+                  after.last_dispatch_seq[APP_EVENT_DIAG_INPUT] - before.dispatch_seq - 1);
+      // The input went ahead of the probe, it is not part of the FIFO
+      shell_print(sh, "FIFO:       %u us, %u events ahead", after.latency_last_us[APP_EVENT_DIAG_LOAD],
+                  after.last_dispatch_seq[APP_EVENT_DIAG_LOAD] - before.dispatch_seq - 2);
+      return 0;
+    }
+  }
+  shell_error(sh, "Probes not dispatched within %d ms", FLOOD_WAIT_MS);
+  return -ETIMEDOUT;
+}
+
+SHELL_SUBCMD_ADD((diag), flood, NULL, "[n] [handler us] Input latency behind n synthetic loads", cmd_flood, 1, 2);
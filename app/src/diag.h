@@ -0,0 +1,9 @@
+#ifndef DIAG_H
+#define DIAG_H
+
+#include "app/bus.h"
+
+/* Handles the synthetic events of "diag flood"; nothing else subscribes to them */
+extern bus_subscriber_t diag_subscriber;
+
+#endif  // DIAG_H
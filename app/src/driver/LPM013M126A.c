@@ -3,6 +3,12 @@
 LOG_MODULE_REGISTER(LPM013M126A, LOG_LEVEL_DBG);
 
 /* ===== Internal state ===== */
+static const struct gpio_dt_spec dp_ext = GPIO_DT_SPEC_GET(DP_EXT_PIN, gpios);
+static const struct gpio_dt_spec dp_on = GPIO_DT_SPEC_GET(DP_ON_PIN, gpios);
+static const struct gpio_dt_spec dp_cs = GPIO_DT_SPEC_GET(DP_CS_PIN, gpios);
+static const struct pwm_dt_spec dp_bl = PWM_DT_SPEC_GET(DT_ALIAS(dpbl));
+static const struct spi_dt_spec lcd_spi = SPI_DT_SPEC_GET(LPM_NODE, OPERATION, 0);
+
 static struct spi_config lcd_cfg; /* will clone from DTS config */
 
 static uint8_t background = LCD_COLOR_WHITE;
@@ -15,8 +21,13 @@ static bool ext_state = 0;
 static int window_x = 0, window_y = 0, window_w = LCD_DISP_WIDTH, window_h = LCD_DISP_HEIGHT;
 
 /* Buffer: 176x176, 4bpp => 2 pixel/byte => 88 byte/line => ~15.5 KB */
-static uint8_t cmd_buf[LCD_DISP_WIDTH / 2];                      /* 88 bytes */
-static uint8_t disp_buf[(LCD_DISP_WIDTH / 2) * LCD_DISP_HEIGHT]; /* 88 * 176 */
+static uint8_t cmd_buf[LCD_DISP_WIDTH / 2]; /* 88 bytes */
+static uint8_t disp_buf[LCD_FRAME_BYTES];   /* 88 * 176 */
+
+/* One bit per buffer line that differs from what the panel is showing */
+static uint32_t dirty_rows[(LCD_DISP_HEIGHT + 31) / 32];
+
+static struct cmlcd_stats stats;
 
 /* ===================================== Helpers ===================================== */
 
@@ -27,6 +38,16 @@ static inline void gpio_set_active(const struct gpio_dt_spec* s, bool active) {
   gpio_pin_set_dt(s, active ? (is_active_low ? 0 : 1) : (is_active_low ? 1 : 0));
 }
 
+static inline void row_mark_dirty(int row) { dirty_rows[row / 32] |= BIT(row % 32); }
+
+static inline bool row_test_and_clear_dirty(int row) {
+  bool dirty = (dirty_rows[row / 32] & BIT(row % 32)) != 0;
+  dirty_rows[row / 32] &= ~BIT(row % 32);
+  return dirty;
+}
+
+static inline void rows_mark_all_dirty(void) { memset(dirty_rows, 0xFF, sizeof(dirty_rows)); }
+
 /* Manual CS (alias lcdcs) */
 static inline void cs_set_active(bool active) { gpio_set_active(&dp_cs, active); }
 
@@ -155,12 +176,17 @@ void cmlcd_draw_pixel(int16_t x, int16_t y, uint8_t color) {
   if (y < window_y || y >= window_y + window_h) return;
 
   size_t idx = ((window_w / 2) * (y - window_y)) + ((x - window_x) / 2);
+  uint8_t val;
   if ((x & 1) == 0) {
     /* even x -> high nibble */
-    disp_buf[idx] = (disp_buf[idx] & 0x0F) | ((color & 0x0F) << 4);
+    val = (disp_buf[idx] & 0x0F) | ((color & 0x0F) << 4);
   } else {
     /* odd x -> low nibble */
-    disp_buf[idx] = (disp_buf[idx] & 0xF0) | (color & 0x0F);
+    val = (disp_buf[idx] & 0xF0) | (color & 0x0F);
+  }
+  if (val != disp_buf[idx]) {
+    disp_buf[idx] = val;
+    row_mark_dirty(y - window_y);
   }
 }
 
@@ -168,6 +194,20 @@ void cmlcd_cls(void) {
   uint8_t nib = (background & 0x0F);
   uint8_t pair = (nib << 4) | nib;
   memset(disp_buf, pair, sizeof(disp_buf));
+  rows_mark_all_dirty();
+}
+
+void cmlcd_frame_save(uint8_t* dst) { memcpy(dst, disp_buf, sizeof(disp_buf)); }
+
+void cmlcd_frame_restore(const uint8_t* src) {
+  const size_t stride = window_w / 2;
+
+  for (int i = 0; i < window_h; ++i) {
+    if (memcmp(&disp_buf[stride * i], &src[stride * i], stride) != 0) {
+      memcpy(&disp_buf[stride * i], &src[stride * i], stride);
+      row_mark_dirty(i);
+    }
+  }
 }
 
 void cmlcd_clear_display(void) {
@@ -181,6 +221,8 @@ void cmlcd_clear_display(void) {
     return;
   }
   k_msleep(15);  // wait for deletion
+  /* Panel and buffer both hold the background now */
+  memset(dirty_rows, 0, sizeof(dirty_rows));
   extcomin_toggle();
 }
 
@@ -193,8 +235,14 @@ void cmlcd_refresh(void) {
   uint8_t bg_row[LCD_DISP_WIDTH / 2];
   memset(bg_row, pair, sizeof(bg_row));
 
+  uint32_t start = k_cycle_get_32();
+  uint32_t rows = 0;
+  int16_t y1 = -1, y2 = -1;
+
   for (int i = 0; i < window_h; ++i) {
     if (window_y + i >= LCD_DISP_HEIGHT) break;
+    /* Memory-in-pixel panel keeps unchanged lines, skip them */
+    if (!row_test_and_clear_dirty(i)) continue;
 
     memcpy(cmd_buf, bg_row, sizeof(cmd_buf));
     memcpy(&cmd_buf[window_x / 2], &disp_buf[(window_w / 2) * i], copy_width);
@@ -215,8 +263,23 @@ void cmlcd_refresh(void) {
 
     if (err) {
       LOG_ERR("Refresh SPI failed at line %d (%d)", window_y + i, err);
+      row_mark_dirty(i);
       break;
     }
+
+    rows++;
+    if (y1 < 0) y1 = window_y + i;
+    y2 = window_y + i;
   }
   extcomin_toggle();
+
+  stats.refreshes++;
+  stats.rows += rows;
+  stats.bytes += rows * LCD_LINE_XFER_BYTES;
+  stats.last_rows = rows;
+  stats.last_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+  stats.last_y1 = y1;
+  stats.last_y2 = y2;
 }
+
+void cmlcd_stats_get(struct cmlcd_stats* out) { *out = stats; }
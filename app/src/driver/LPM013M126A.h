@@ -33,6 +33,11 @@
 #define LCD_DISP_HEIGHT (176)
 #define LCD_DISP_HEIGHT_MAX_BUF (44)
 
+/** @def
+ * Size of one panel-format frame (4bpp, 2 pixel/byte)
+ */
+#define LCD_FRAME_BYTES ((LCD_DISP_WIDTH / 2) * LCD_DISP_HEIGHT)
+
 /** @def
  * some RGB color definitions
  */
@@ -79,13 +84,6 @@
 #define FREQUENCY_8MHZ (8000000)
 #define FREQUENCY_16MHZ (16000000)
 
-/* internal state */
-static const struct gpio_dt_spec dp_ext = GPIO_DT_SPEC_GET(DP_EXT_PIN, gpios);
-static const struct gpio_dt_spec dp_on = GPIO_DT_SPEC_GET(DP_ON_PIN, gpios);
-static const struct gpio_dt_spec dp_cs = GPIO_DT_SPEC_GET(DP_CS_PIN, gpios);
-static const struct pwm_dt_spec dp_bl = PWM_DT_SPEC_GET(DT_ALIAS(dpbl));
-static const struct spi_dt_spec lcd_spi = SPI_DT_SPEC_GET(LPM_NODE, OPERATION, 0);
-
 int cmlcd_init(void);
 int cmlcd_backlight_set(uint8_t percent);
 void cmlcd_draw_pixel(int16_t x, int16_t y, uint8_t color);
@@ -94,3 +92,38 @@ void cmlcd_clear_display(void);
 void cmlcd_refresh(void);
 void cmlcd_set_blink_mode(uint8_t mode);
 void cmlcd_set_trans_mode(uint8_t mode);
+
+/** @def
+ * Bytes on the wire per panel line: command + address, 88 data bytes, 2 dummy bytes
+ */
+#define LCD_LINE_XFER_BYTES (2 + (LCD_DISP_WIDTH / 2) + 2)
+
+/* Panel transfer counters, cumulative since boot except for the last_* fields */
+struct cmlcd_stats {
+  uint32_t refreshes;
+  uint32_t rows;
+  uint32_t bytes;
+  uint32_t last_rows;
+  uint32_t last_us;
+  int16_t last_y1;
+  int16_t last_y2;
+};
+
+/**
+ * @brief Read the panel transfer counters.
+ */
+void cmlcd_stats_get(struct cmlcd_stats* stats);
+
+/**
+ * @brief Copy the current panel-format frame buffer out.
+ * @param dst Destination of LCD_FRAME_BYTES bytes.
+ */
+void cmlcd_frame_save(uint8_t* dst);
+
+/**
+ * @brief Replace the frame buffer with a previously saved frame.
+ * Only rows that differ from the current content are marked dirty, so the
+ * next cmlcd_refresh() transfers just those rows.
+ * @param src Source of LCD_FRAME_BYTES bytes.
+ */
+void cmlcd_frame_restore(const uint8_t* src);
@@ -1,15 +1,303 @@
 #include "event.h"
 
+#include <errno.h>
+#include <stdlib.h>
+#include <zephyr/drivers/rtc.h>
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+
+#include "hal/ancs_client.h"
 
 LOG_MODULE_REGISTER(event_module, LOG_LEVEL_DBG);
 
+/* Only the latest value of these matters; a pending one is overwritten in place */
+#define EVENT_COALESCED_MASK                                                                             \
+  (BIT(APP_EVENT_RTC_ALARM) | BIT(APP_EVENT_BATTERY) | BIT(APP_EVENT_MODE_TIMEOUT) | BIT(APP_EVENT_RTC_SECOND) | \
+   BIT(APP_EVENT_STOPWATCH_TICK))
+
+BUILD_ASSERT(APP_EVENT_COUNT <= 32, "pending mask holds one bit per event type");
+
+/* Last dispatched events kept for "diag trace", a power of two */
+#define EVENT_TRACE_LEN 64
+#define EVENT_HANDLER_BUDGET_US 20000
+
+/* Dispatched before anything else so input never waits behind a burst */
+#define EVENT_INPUT_MASK (BIT(APP_EVENT_BUTTON) | BIT(APP_EVENT_DIAG_INPUT))
+
+/* Input lane, then the FIFO for events that each carry something: notifications, CTS */
+K_MSGQ_DEFINE(app_input_msgq, sizeof(app_event_t), 4, 4);
 K_MSGQ_DEFINE(app_msgq, sizeof(app_event_t), 10, 4);
+/* Counts queued messages in both lanes plus occupied coalescing slots */
+K_SEM_DEFINE(app_event_sem, 0, K_SEM_MAX_LIMIT);
+
+/*
+ * Payload pools: fixed-size blocks per event type that carries a pointer.
+ * ANCS can fill its FIFO share and have one more in dispatch and one being
+ * assembled; messages and CTS updates are one at a time.
+ */
+K_MEM_SLAB_DEFINE_STATIC(ancs_payloads, sizeof(ancs_noti_info_t), 12, 4);
+K_MEM_SLAB_DEFINE_STATIC(ancs_body_payloads, sizeof(ancs_noti_body_t), 2, 4);
+K_MEM_SLAB_DEFINE_STATIC(cts_payloads, sizeof(struct rtc_time), 2, 4);
+
+static struct k_mem_slab* const payload_pools[APP_EVENT_COUNT] = {
+    [APP_EVENT_BLE_ANCS] = &ancs_payloads,
+    [APP_EVENT_BLE_ANCS_BODY] = &ancs_body_payloads,
+    [APP_EVENT_BLE_CTS] = &cts_payloads,
+};
+
+static struct k_spinlock lock;
+static app_event_t slots[APP_EVENT_COUNT];
+static uint32_t pending;
+static struct event_stats stats;
+
+static struct event_trace_rec trace[EVENT_TRACE_LEN];
+static uint32_t trace_count;  // records written since boot
+static uint32_t handler_budget_us = EVENT_HANDLER_BUDGET_US;
+static uint32_t filter = UINT32_MAX;
+
+static int event_post_coalesced(const app_event_t* event) {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+  bool fresh = (pending & BIT(event->type)) == 0;
+
+  slots[event->type] = *event;
+  pending |= BIT(event->type);
+  stats.posted[event->type]++;
+  if (!fresh) {
+    stats.coalesced[event->type]++;
+  }
+  k_spin_unlock(&lock, key);
+
+  if (fresh) {
+    k_sem_give(&app_event_sem);
+  }
+  return 0;
+}
 
 int event_post(app_event_t* event) {
-  LOG_INF("Posting event type: %u", event->type);
-  return k_msgq_put(&app_msgq, event, K_NO_WAIT);
+  if (event->type >= APP_EVENT_COUNT) {
+    return -EINVAL;
+  }
+  // Payload events are always queued, their producers hand over more than the pool block
+  if (!(BIT(event->type) & filter) && payload_pools[event->type] == NULL) {
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    stats.filtered[event->type]++;
+    k_spin_unlock(&lock, key);
+    return 0;
+  }
+  event->posted_at = k_cycle_get_32();
+  event->depth = MIN(k_sem_count_get(&app_event_sem), UINT8_MAX);
+  if (BIT(event->type) & EVENT_COALESCED_MASK) {
+    return event_post_coalesced(event);
+  }
+
+  struct k_msgq* lane = (BIT(event->type) & EVENT_INPUT_MASK) ? &app_input_msgq : &app_msgq;
+  int ret = k_msgq_put(lane, event, K_NO_WAIT);
+  k_spinlock_key_t key = k_spin_lock(&lock);
+  if (ret == 0) {
+    stats.posted[event->type]++;
+  } else {
+    stats.dropped[event->type]++;
+  }
+  k_spin_unlock(&lock, key);
+
+  if (ret != 0) {
+    LOG_WRN("Event queue full, dropped type %u", event->type);
+    return ret;
+  }
+  k_sem_give(&app_event_sem);
+  return 0;
+}
+
+static void event_latency_record(const app_event_t* event) {
+  uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - event->posted_at);
+  k_spinlock_key_t key = k_spin_lock(&lock);
+
+  stats.dispatched[event->type]++;
+  stats.latency_total_us[event->type] += us;
+  stats.latency_max_us[event->type] = MAX(stats.latency_max_us[event->type], us);
+  stats.latency_last_us[event->type] = us;
+  stats.last_dispatch_seq[event->type] = ++stats.dispatch_seq;
+  k_spin_unlock(&lock, key);
+}
+
+int event_get(app_event_t* event, k_timeout_t timeout) {
+  int ret = k_sem_take(&app_event_sem, timeout);
+  if (ret != 0) {
+    return ret;
+  }
+
+  if (k_msgq_get(&app_input_msgq, event, K_NO_WAIT) != 0 && k_msgq_get(&app_msgq, event, K_NO_WAIT) != 0) {
+    // The semaphore was given for a coalescing slot
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    __ASSERT_NO_MSG(pending != 0);
+    app_event_type_t type = (app_event_type_t)(find_lsb_set(pending) - 1);
+    *event = slots[type];
+    pending &= ~BIT(type);
+    k_spin_unlock(&lock, key);
+  }
+  event_latency_record(event);
+  return 0;
+}
+
+void event_trace_record(const app_event_t* event, uint32_t dispatched_at) {
+  uint32_t handler_us = k_cyc_to_us_floor32(k_cycle_get_32() - dispatched_at);
+  k_spinlock_key_t key = k_spin_lock(&lock);
+  struct event_trace_rec* rec = &trace[trace_count++ % EVENT_TRACE_LEN];
+
+  rec->type = event->type;
+  rec->depth = event->depth;
+  rec->posted_at = event->posted_at;
+  rec->dispatched_at = dispatched_at;
+  rec->handler_us = handler_us;
+  bool over = handler_us > handler_budget_us;
+  if (over) {
+    stats.over_budget[event->type]++;
+  }
+  k_spin_unlock(&lock, key);
+
+  if (over) {
+    LOG_WRN("Handler for event type %u took %u us (budget %u us)", event->type, handler_us, handler_budget_us);
+  }
+}
+
+void* event_payload_alloc(app_event_type_t type) {
+  void* block;
+
+  if (type >= APP_EVENT_COUNT || payload_pools[type] == NULL) {
+    return NULL;
+  }
+  if (k_mem_slab_alloc(payload_pools[type], &block, K_NO_WAIT) != 0) {
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    stats.payload_failed[type]++;
+    k_spin_unlock(&lock, key);
+    LOG_WRN("Payload pool for type %u exhausted", type);
+    return NULL;
+  }
+  return block;
+}
+
+void event_payload_free(app_event_type_t type, void* payload) {
+  if (payload == NULL || type >= APP_EVENT_COUNT || payload_pools[type] == NULL) {
+    return;
+  }
+  k_mem_slab_free(payload_pools[type], payload);
+}
+
+void event_release(app_event_t* event) {
+  if (payload_pools[event->type] != NULL) {
+    event_payload_free(event->type, event->ptr);
+    event->ptr = NULL;
+  }
+}
+
+void event_set_filter(uint32_t mask) { filter = mask; }
+
+void event_stats_get(struct event_stats* out) {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+  *out = stats;
+  k_spin_unlock(&lock, key);
+
+  // Blocks still in use while the queues are idle point at a leak
+  for (int i = 0; i < APP_EVENT_COUNT; i++) {
+    if (payload_pools[i]) {
+      out->payload_used[i] = k_mem_slab_num_used_get(payload_pools[i]);
+      out->payload_peak[i] = k_mem_slab_max_used_get(payload_pools[i]);
+    }
+  }
+}
+
+#ifdef CONFIG_SHELL
+/* Copy of the trace ring, oldest first */
+static uint32_t trace_snapshot(struct event_trace_rec* out) {
+  k_spinlock_key_t key = k_spin_lock(&lock);
+  uint32_t n = MIN(trace_count, EVENT_TRACE_LEN);
+
+  for (uint32_t i = 0; i < n; i++) {
+    out[i] = trace[(trace_count - n + i) % EVENT_TRACE_LEN];
+  }
+  k_spin_unlock(&lock, key);
+  return n;
+}
+
+static void sort_u32(uint32_t* v, uint32_t n) {
+  for (uint32_t i = 1; i < n; i++) {
+    uint32_t x = v[i];
+    uint32_t j = i;
+    for (; j > 0 && v[j - 1] > x; j--) {
+      v[j] = v[j - 1];
+    }
+    v[j] = x;
+  }
+}
+
+static void print_percentiles(const struct shell* sh, const char* name, uint32_t* v, uint32_t n) {
+  sort_u32(v, n);
+  shell_print(sh, "%-10s p50 %6u  p90 %6u  p99 %6u  max %6u us", name, v[n / 2], v[n * 9 / 10], v[n * 99 / 100],
+              v[n - 1]);
+}
+
+static int cmd_trace(const struct shell* sh, size_t argc, char** argv) {
+  static struct event_trace_rec recs[EVENT_TRACE_LEN];
+  static uint32_t values[EVENT_TRACE_LEN];
+  uint32_t n = trace_snapshot(recs);
+
+  if (n == 0) {
+    shell_print(sh, "No events traced yet");
+    return 0;
+  }
+  for (uint32_t i = 0; i < n; i++) {
+    values[i] = k_cyc_to_us_floor32(recs[i].dispatched_at - recs[i].posted_at);
+  }
+  shell_print(sh, "Last %u events, handler budget %u us", n, handler_budget_us);
+  print_percentiles(sh, "latency", values, n);
+  for (uint32_t i = 0; i < n; i++) {
+    values[i] = recs[i].handler_us;
+  }
+  print_percentiles(sh, "handler", values, n);
+  return 0;
+}
+
+static int cmd_trace_dump(const struct shell* sh, size_t argc, char** argv) {
+  static struct event_trace_rec recs[EVENT_TRACE_LEN];
+  uint32_t n = trace_snapshot(recs);
+
+  shell_print(sh, "type depth  latency us  handler us");
+  for (uint32_t i = 0; i < n; i++) {
+    shell_print(sh, "%4u %5u %11u %11u%s", recs[i].type, recs[i].depth,
+                k_cyc_to_us_floor32(recs[i].dispatched_at - recs[i].posted_at), recs[i].handler_us,
+                recs[i].handler_us > handler_budget_us ? "  over budget" : "");
+  }
+  return 0;
+}
+
+static int cmd_trace_budget(const struct shell* sh, size_t argc, char** argv) {
+  if (argc > 1) {
+    handler_budget_us = strtoul(argv[1], NULL, 10);
+  }
+  shell_print(sh, "Handler budget %u us", handler_budget_us);
+  return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(trace_cmds, SHELL_CMD(dump, NULL, "Print the trace ring", cmd_trace_dump),
+                               SHELL_CMD_ARG(budget, NULL, "[us] Show or set the handler budget", cmd_trace_budget,
+                                             1, 1),
+                               SHELL_SUBCMD_SET_END);
+SHELL_SUBCMD_ADD((diag), trace, &trace_cmds, "Event latency and handler time percentiles", cmd_trace, 1, 0);
+
+static int cmd_events(const struct shell* sh, size_t argc, char** argv) {
+  struct event_stats s;
+
+  event_stats_get(&s);
+  shell_print(sh, "type   posted coalesced  dropped filtered  avg us  max us  slow  payloads used/peak/failed");
+  for (int i = 0; i < APP_EVENT_COUNT; i++) {
+    shell_print(sh, "%4d %8u %9u %8u %8u %7u %7u %5u  %u/%u/%u", i, s.posted[i], s.coalesced[i], s.dropped[i],
+                s.filtered[i], s.dispatched[i] ? s.latency_total_us[i] / s.dispatched[i] : 0, s.latency_max_us[i],
+                s.over_budget[i], s.payload_used[i], s.payload_peak[i], s.payload_failed[i]);
+  }
+  return 0;
 }
 
-int event_get(app_event_t* event, k_timeout_t timeout) { return k_msgq_get(&app_msgq, event, timeout); }
+SHELL_SUBCMD_ADD((diag), events, NULL, "Event broker counters", cmd_events, 1, 0);
+#endif
@@ -11,6 +11,16 @@ typedef enum {
   APP_EVENT_BLE_CTS,
   APP_EVENT_BATTERY,
   APP_EVENT_MODE_TIMEOUT,
+  APP_EVENT_RTC_SECOND,
+  APP_EVENT_STOPWATCH_TICK,
+  APP_EVENT_BLE_ANCS_REMOVED,  // value: notification UID
+  APP_EVENT_BLE_ANCS_BODY,     // ptr: ancs_noti_body_t, a message fetched on request
+  APP_EVENT_BLE_ANCS_SESSION,  // ANCS (re)subscribed, UIDs of earlier sessions are void
+  APP_EVENT_BLE_ANCS_SYNCED,   // the session's backlog is in, what it did not replay is gone
+  APP_EVENT_BLE_ANCS_IDLE,     // every head asked for is posted, a burst is over
+  APP_EVENT_DIAG_LOAD,         // value: handler time in us, synthetic load of "diag flood"
+  APP_EVENT_DIAG_INPUT,        // input lane probe of "diag flood"
+  APP_EVENT_COUNT,
 } app_event_type_t;
 
 typedef struct {
@@ -20,9 +30,82 @@ typedef struct {
     void* ptr;
   };
   size_t len;
+  uint32_t posted_at;  // k_cycle_get_32() when posted, set by event_post()
+  uint8_t depth;       // items already queued when posted, set by event_post()
 } app_event_t;
 
+/* One dispatched event in the trace ring */
+struct event_trace_rec {
+  uint8_t type;
+  uint8_t depth;
+  uint16_t reserved;
+  uint32_t posted_at;      // cycles
+  uint32_t dispatched_at;  // cycles
+  uint32_t handler_us;
+};
+
+/* Per-type counters since boot */
+struct event_stats {
+  uint32_t posted[APP_EVENT_COUNT];
+  uint32_t coalesced[APP_EVENT_COUNT];  // overwrote a pending event of the same type
+  uint32_t dropped[APP_EVENT_COUNT];    // queue full, the event was lost
+  // Post-to-dispatch latency
+  uint32_t dispatched[APP_EVENT_COUNT];
+  uint32_t latency_total_us[APP_EVENT_COUNT];
+  uint32_t latency_max_us[APP_EVENT_COUNT];
+  uint32_t latency_last_us[APP_EVENT_COUNT];
+  uint32_t dispatch_seq;                        // events dispatched, all types
+  uint32_t last_dispatch_seq[APP_EVENT_COUNT];  // dispatch_seq at the last event of each type
+  // Payload pools, zero for types without one
+  uint32_t payload_used[APP_EVENT_COUNT];
+  uint32_t payload_peak[APP_EVENT_COUNT];
+  uint32_t payload_failed[APP_EVENT_COUNT];
+  uint32_t over_budget[APP_EVENT_COUNT];  // handlers that ran past the trace budget
+  uint32_t filtered[APP_EVENT_COUNT];     // nobody subscribed, not queued
+};
+
+/**
+ * @brief Post an event to the app task. Safe from ISR and BT callbacks.
+ * Input events go to a priority lane that event_get() always drains first.
+ * State-style events (time ticks, battery, mode timeout) never fail: a
+ * pending one of the same type is overwritten with the newer value.
+ * @return 0 on success, -ENOMSG if the queue is full. The caller still
+ * owns @p event's payload on failure.
+ */
 int event_post(app_event_t* event);
 int event_get(app_event_t* event, k_timeout_t timeout);
 
+/**
+ * @brief Take a payload block for an event of @p type from its fixed-size pool.
+ * Never blocks, so it is safe from ISR and BT callbacks. Ownership passes
+ * to the app task with a successful event_post(); on failure give the
+ * block back with event_payload_free().
+ * @return The block, or NULL if @p type has no pool or the pool is empty.
+ */
+void* event_payload_alloc(app_event_type_t type);
+void event_payload_free(app_event_type_t type, void* payload);
+
+/**
+ * @brief Return the payload of a dispatched event to its pool.
+ * Called by the app task once every handler has run.
+ */
+void event_release(app_event_t* event);
+
+void event_stats_get(struct event_stats* stats);
+
+/**
+ * @brief Only queue events whose type bit is set in @p mask; event_post()
+ * counts and skips the others and still returns 0. Events with a payload
+ * are always queued. All types pass until this is called, see app/bus.c.
+ */
+void event_set_filter(uint32_t mask);
+
+/**
+ * @brief Append a dispatched event to the trace ring.
+ * Called by the app task after all handlers ran; flags handlers that
+ * took longer than the budget (see "diag trace budget").
+ * @param dispatched_at k_cycle_get_32() when the event was taken off the queue.
+ */
+void event_trace_record(const app_event_t* event, uint32_t dispatched_at);
+
 #endif /* EVENT_H */
@@ -0,0 +1,150 @@
+#include "ancs_apps.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/util.h>
+
+LOG_MODULE_REGISTER(ancs_apps);
+
+#define APP_KEY_LEN sizeof("ancs_app/255")
+
+static K_MUTEX_DEFINE(apps_lock);
+static struct ancs_app apps[ANCS_APPS_LEN];  // empty id: free slot
+static uint32_t apps_used[ANCS_APPS_LEN];    // LRU stamps, not saved
+static uint32_t apps_clock;
+static struct ancs_apps_stats apps_stats;
+
+static int apps_find(const char* app_id) {
+  for (int i = 0; i < ANCS_APPS_LEN; i++) {
+    if (apps[i].id[0] != '\0' && strcmp(apps[i].id, app_id) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/* Slot for a new entry: a free one, else the least recently used */
+static int apps_claim(void) {
+  int slot = 0;
+
+  for (int i = 0; i < ANCS_APPS_LEN; i++) {
+    if (apps[i].id[0] == '\0') {
+      return i;
+    }
+    if (apps_used[i] < apps_used[slot]) {
+      slot = i;
+    }
+  }
+  return slot;
+}
+
+static void apps_save(int slot) {
+#ifdef CONFIG_SETTINGS
+  char key[APP_KEY_LEN];
+  char value[sizeof(apps[0])];  // "id\0name", the name unterminated
+  size_t id_len = strlen(apps[slot].id) + 1;
+  size_t name_len = strlen(apps[slot].name);
+
+  memcpy(value, apps[slot].id, id_len);
+  memcpy(value + id_len, apps[slot].name, name_len);
+  snprintf(key, sizeof(key), "ancs_app/%d", slot);
+  int err = settings_save_one(key, value, id_len + name_len);
+  if (err) {
+    LOG_ERR("Failed to save app name (err %d)", err);
+  }
+#endif
+}
+
+bool ancs_apps_lookup(const char* app_id, char* name, size_t size) {
+  k_mutex_lock(&apps_lock, K_FOREVER);
+  int slot = apps_find(app_id);
+
+  if (slot < 0) {
+    apps_stats.misses++;
+  } else {
+    apps_stats.hits++;
+    apps_used[slot] = ++apps_clock;
+    snprintf(name, size, "%s", apps[slot].name);
+  }
+  k_mutex_unlock(&apps_lock);
+  return slot >= 0;
+}
+
+void ancs_apps_store(const char* app_id, const char* name) {
+  k_mutex_lock(&apps_lock, K_FOREVER);
+  int slot = apps_find(app_id);
+
+  if (slot >= 0 && strcmp(apps[slot].name, name) == 0) {
+    k_mutex_unlock(&apps_lock);
+    return;
+  }
+  if (slot < 0) {
+    slot = apps_claim();
+    if (apps[slot].id[0] != '\0') {
+      LOG_INF("Evicting %s", apps[slot].id);
+    }
+    snprintf(apps[slot].id, sizeof(apps[slot].id), "%s", app_id);
+  }
+  snprintf(apps[slot].name, sizeof(apps[slot].name), "%s", name);
+  apps_used[slot] = ++apps_clock;
+  apps_save(slot);
+  k_mutex_unlock(&apps_lock);
+}
+
+void ancs_apps_stats_get(struct ancs_apps_stats* stats) {
+  k_mutex_lock(&apps_lock, K_FOREVER);
+  *stats = apps_stats;
+  stats->count = 0;
+  for (int i = 0; i < ANCS_APPS_LEN; i++) {
+    stats->count += apps[i].id[0] != '\0';
+  }
+  k_mutex_unlock(&apps_lock);
+}
+
+bool ancs_apps_get(uint8_t index, struct ancs_app* app) {
+  bool found = false;
+
+  k_mutex_lock(&apps_lock, K_FOREVER);
+  for (int i = 0; i < ANCS_APPS_LEN && !found; i++) {
+    if (apps[i].id[0] != '\0' && index-- == 0) {
+      *app = apps[i];
+      found = true;
+    }
+  }
+  k_mutex_unlock(&apps_lock);
+  return found;
+}
+
+#ifdef CONFIG_SETTINGS
+static int apps_settings_set(const char* name, size_t len, settings_read_cb read_cb, void* cb_arg) {
+  char value[sizeof(apps[0])];
+  char* end;
+  unsigned long slot = strtoul(name, &end, 10);
+
+  if (end == name || *end != '\0' || slot >= ANCS_APPS_LEN || len > sizeof(value)) {
+    return -ENOENT;
+  }
+  ssize_t n = read_cb(cb_arg, value, len);
+  if (n < 0) {
+    return -EIO;
+  }
+
+  size_t id_len = strnlen(value, n);
+  if (id_len == 0 || id_len == n || id_len >= sizeof(apps[0].id) || n - id_len - 1 >= sizeof(apps[0].name)) {
+    return -EINVAL;
+  }
+  k_mutex_lock(&apps_lock, K_FOREVER);
+  memcpy(apps[slot].id, value, id_len + 1);
+  memcpy(apps[slot].name, value + id_len + 1, n - id_len - 1);
+  apps[slot].name[n - id_len - 1] = '\0';
+  k_mutex_unlock(&apps_lock);
+  return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(ancs_app, "ancs_app", NULL, apps_settings_set, NULL, NULL);
+#endif
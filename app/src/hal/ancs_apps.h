@@ -0,0 +1,49 @@
+#ifndef ANCS_APPS_H
+#define ANCS_APPS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ancs_client.h"
+
+/*
+ * Display names of the apps notifications come from, keyed by ANCS app
+ * identifier (bundle ID). A few apps send most notifications, so the ANCS
+ * client only asks the phone for a name on a miss. Entries are saved in
+ * settings, one "ancs_app/<slot>" record each, holding both strings packed.
+ */
+#define ANCS_APPS_LEN 16
+
+struct ancs_app {
+  char id[ATTR_APP_ID_MAX];
+  char name[ATTR_COMMON_SIZE];  // empty when the phone had none
+};
+
+struct ancs_apps_stats {
+  uint32_t hits;
+  uint32_t misses;
+  uint8_t count;
+};
+
+/**
+ * @brief Copy the display name of @p app_id into @p name.
+ * @return true on a hit; the name is empty when the phone had none.
+ */
+bool ancs_apps_lookup(const char* app_id, char* name, size_t size);
+
+/**
+ * @brief Cache and save the display name of @p app_id, replacing the least
+ * recently used entry when full.
+ */
+void ancs_apps_store(const char* app_id, const char* name);
+
+void ancs_apps_stats_get(struct ancs_apps_stats* stats);
+
+/**
+ * @brief Copy entry @p index, for listing.
+ * @return false past the last entry.
+ */
+bool ancs_apps_get(uint8_t index, struct ancs_app* app);
+
+#endif  // ANCS_APPS_H
@@ -7,8 +7,13 @@
 #include "ancs_client.h"
 
 #include <bluetooth/gatt_dm.h>
+#include <bluetooth/services/ancs_client.h>
 #include <bluetooth/services/gattp.h>
+#include <errno.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/bluetooth/conn.h>
 #include <zephyr/bluetooth/gatt.h>
@@ -16,37 +21,199 @@
 #include <zephyr/bluetooth/uuid.h>
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/shell/shell.h>
 #include <zephyr/sys/atomic.h>
 #include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/ring_buffer.h>
 
+#include "ancs_apps.h"
+#include "ble.h"
+#include "conn_params.h"
 #include "event.h"
+#include "gatt_cache.h"
 
 LOG_MODULE_REGISTER(app_ancs_client);
 
+/* Allocated size for attribute data. */
+#define ATTR_DATA_SIZE BT_ANCS_ATTR_DATA_MAX
+
 enum { DISCOVERY_ANCS_ONGOING, DISCOVERY_ANCS_SUCCEEDED, SERVICE_CHANGED_INDICATED };
 
 static struct bt_ancs_client ancs_c;
 static struct bt_gattp gattp;
 static atomic_t discovery_flags;
+static uint32_t secured_at;
+static uint32_t ready_ms;  // from encryption to subscribing, for "diag ancs"
+static bool ready_cached;
+
+/*
+ * Cached handles are trusted only once the Notification Source CCC reads
+ * back as subscribed; a failed or missing answer falls back to discovery.
+ */
+#define CACHE_CHECK_MS 3000
+static bool cache_unproven;
+static struct bt_gatt_read_params cache_check_params;
+static void cache_check_work_fn(struct k_work* work);
+static K_WORK_DELAYABLE_DEFINE(cache_check_work, cache_check_work_fn);
 
 /* Local copy to keep track of the newest arriving notifications. */
 static struct bt_ancs_evt_notif notification_latest;
 /* Local copy of the newest notification attribute. */
 static struct bt_ancs_attr notif_attr_latest;
 typedef struct {
-  uint8_t app_id[ATTR_APP_ID_SIZE];
+  uint8_t app_id[ATTR_APP_ID_MAX];
   uint8_t title[ATTR_TITLE_SIZE];
-  uint8_t subtitle[ATTR_COMMON_SIZE];
   uint8_t message[ATTR_MESSAGE_SIZE];
-  uint8_t message_size[ATTR_COMMON_SIZE];
-  uint8_t date[ATTR_COMMON_SIZE];
-  uint8_t posaction[ATTR_COMMON_SIZE];
-  uint8_t negaction[ATTR_COMMON_SIZE];
   uint8_t disp_name[ATTR_COMMON_SIZE];
 } ancs_attr_buffers_t;
 
 static ancs_attr_buffers_t attr_bufs;
 
+/*
+ * Get Notification Attributes requests are queued and sent one at a time:
+ * the client parses a single response, so the next request goes out as soon
+ * as the last attribute of the previous one has arrived. Notifications are
+ * fetched in two phases, app and title when they arrive and the message only
+ * when opened; the registered attributes' get flags select the phase for
+ * each request. A head whose app is not in ancs_apps stays in flight until
+ * the phone tells the app's display name.
+ */
+#define HEAD_ATTRS (BIT(BT_ANCS_NOTIF_ATTR_ID_APP_IDENTIFIER) | BIT(BT_ANCS_NOTIF_ATTR_ID_TITLE))
+#define BODY_ATTRS BIT(BT_ANCS_NOTIF_ATTR_ID_MESSAGE)
+
+#define FETCH_QUEUE_LEN 16
+#define FETCH_RETRY_MS 20  // control point write in progress or no ATT buffer
+#define FETCH_MAX_RETRIES 10
+#define FETCH_TIMEOUT_MS 2000  // the phone never completed the response
+
+/*
+ * The backlog the phone replays on connection (PreExisting) and Silent
+ * notifications only have their metadata noted at first; their heads are
+ * fetched in the background while no other request waits, and they never
+ * raise a toast. Important ones go ahead of other heads and are listed
+ * whatever the category filter. Messages are only fetched when opened.
+ */
+#define SYNC_LEN 64  // as many as the model lists
+/*
+ * The phone gives no end to its replay: the backlog counts as in once no
+ * PreExisting event came for this long and every head has been fetched.
+ */
+#define SYNC_SETTLE_MS 1000
+#define CATEGORIES_ALL (BIT(BT_ANCS_CATEGORY_ID_COUNT) - 1)
+
+/* UIDs answered by the simulated phone of "diag ancs burst" */
+#define SIM_UID_BASE 0xF2000000
+#define SIM_UID_MASK 0xFF000000
+#define SIM_INTERVAL_MS 30  // one response per connection event
+
+/*
+ * The notification source and data source handlers run in the Bluetooth RX
+ * thread, so they only copy each event or attribute into ancs_rx_ring; rx_work
+ * handles them in arrival order on the low-priority ancs_wq, so a Removed
+ * never overtakes the attributes of its notification. A full ring drops the
+ * record: a lost attribute makes the fetch time out, a lost event restarts
+ * the session so the phone replays what it has.
+ */
+#define RX_NOTIF_REC_SIZE (sizeof(struct rx_rec) + sizeof(struct bt_ancs_evt_notif))
+#define RX_RING_SIZE (SYNC_LEN * RX_NOTIF_REC_SIZE + 1024)  // the whole backlog, a message and a few heads
+/* Between dropping the Notification Source subscription and asking for it again */
+#define RESYNC_DELAY_MS 100
+#define ANCS_WQ_STACK_SIZE 2048
+#define ANCS_WQ_PRIORITY K_LOWEST_APPLICATION_THREAD_PRIO
+
+struct fetch_req {
+  uint32_t uid;
+  uint8_t attrs;
+  uint8_t category;
+  uint8_t flags;  // ANCS_NOTI_*
+};
+
+/* Response being assembled; attributes for any other UID are stale */
+struct fetch_ctx {
+  uint32_t uid;
+  uint8_t attrs;     // requested
+  uint8_t received;  // BIT() of the attribute IDs arrived so far
+  bool naming;       // waiting for the display name of app_id
+  bool dropped;      // removed by the phone meanwhile: receive the rest, post nothing
+  bool app_id_cut;   // App Identifier longer than app_id, so no name is looked up
+  char app_id[ATTR_APP_ID_MAX];
+  ancs_noti_info_t info;  // info.app is a display copy of app_id
+};
+
+struct fetch_stats {
+  uint32_t requests;  // written to the control point
+  uint32_t completed;
+  uint32_t retries;
+  uint32_t timeouts;
+  uint32_t rejected;
+  uint32_t dropped;   // queue full
+  uint32_t filtered;  // category not listed
+  uint32_t synced;    // heads fetched in the background
+  uint8_t peak;       // queue depth
+  /* Last burst, from a request queued while idle until the queue drained */
+  uint32_t burst_notis;
+  uint32_t burst_ms;
+};
+
+enum rx_kind { RX_NOTIF, RX_ATTR };
+
+/*
+ * Event or attribute as copied into ancs_rx_ring, followed by len bytes of
+ * data: the struct bt_ancs_evt_notif, or the attribute value
+ */
+struct rx_rec {
+  uint32_t uid;
+  uint8_t kind;  // enum rx_kind
+  uint8_t command_id;
+  uint8_t attr_id;
+  uint8_t truncated;  // the phone sent more than the registered buffer holds
+  uint16_t len;
+};
+
+/* Cost of the source callbacks, and of the processing they hand off */
+struct rx_stats {
+  uint32_t records;
+  uint32_t overflows;  // ring full, record dropped
+  uint32_t resyncs;    // sessions restarted over a dropped event
+  uint32_t cb_max_cyc;
+  uint32_t work_max_cyc;  // per record, what the callbacks used to spend
+  uint16_t peak;          // ring bytes used
+};
+
+static K_MUTEX_DEFINE(fetch_lock);
+static struct fetch_req fetch_queue[FETCH_QUEUE_LEN];  // [0] is in flight while fetch_busy
+static uint8_t fetch_count;
+static bool fetch_busy;
+static uint8_t fetch_retries;
+static struct fetch_ctx fetch_ctx;
+static struct fetch_stats fetch_stats;
+static struct fetch_req sync_queue[SYNC_LEN];  // background heads, oldest first
+static uint8_t sync_count;
+static bool sync_open;  // backlog of this session not in yet
+static uint16_t categories = CATEGORIES_ALL;
+static uint32_t burst_start;
+static uint32_t burst_notis;
+static uint32_t sim_interval_ms = SIM_INTERVAL_MS;
+
+static void fetch_work_fn(struct k_work* work);
+static K_WORK_DELAYABLE_DEFINE(fetch_work, fetch_work_fn);
+static void sim_work_fn(struct k_work* work);
+static K_WORK_DELAYABLE_DEFINE(sim_work, sim_work_fn);
+static void sync_work_fn(struct k_work* work);
+static K_WORK_DELAYABLE_DEFINE(sync_work, sync_work_fn);
+
+static struct k_spinlock rx_lock;
+RING_BUF_DECLARE(ancs_rx_ring, RX_RING_SIZE);
+static struct rx_stats rx_stats;
+static bool rx_lost;  // an event did not fit, the model no longer matches the phone
+static K_THREAD_STACK_DEFINE(ancs_wq_stack, ANCS_WQ_STACK_SIZE);
+static struct k_work_q ancs_wq;
+static void rx_work_fn(struct k_work* work);
+static K_WORK_DEFINE(rx_work, rx_work_fn);
+static void resync_work_fn(struct k_work* work);
+static K_WORK_DELAYABLE_DEFINE(resync_work, resync_work_fn);
+
 /* String literals for the iOS notification categories. */
 static const char* lit_catid[BT_ANCS_CATEGORY_ID_COUNT] = {
     "Other", "Incoming Call", "Missed Call",        "Voice Mail",           "Social",   "Schedule",
@@ -69,9 +236,24 @@ static void bt_ancs_notification_source_handler(struct bt_ancs_client* ancs_c, i
                                                 const struct bt_ancs_evt_notif* notif);
 static void bt_ancs_data_source_handler(struct bt_ancs_client* ancs_c, const struct bt_ancs_attr_response* response);
 
+/* Subscribing makes the phone replay its backlog under new UIDs */
+static void session_open(void) {
+  app_event_t event = {.type = APP_EVENT_BLE_ANCS_SESSION};
+
+  // Queued ahead of anything the phone sends once subscribed
+  if (event_post(&event) < 0) {
+    LOG_WRN("ANCS session start not queued");
+  }
+  k_mutex_lock(&fetch_lock, K_FOREVER);
+  sync_open = true;
+  k_mutex_unlock(&fetch_lock);
+  k_work_reschedule(&sync_work, K_MSEC(SYNC_SETTLE_MS));
+}
+
 static void enable_ancs_notifications(struct bt_ancs_client* ancs_c) {
   int err;
 
+  session_open();
   err = bt_ancs_subscribe_notification_source(ancs_c, bt_ancs_notification_source_handler);
   if (err) {
     LOG_ERR("Failed to enable Notification Source notification (err %d)", err);
@@ -81,6 +263,9 @@ static void enable_ancs_notifications(struct bt_ancs_client* ancs_c) {
   if (err) {
     LOG_ERR("Failed to enable Data Source notification (err %d)", err);
   }
+
+  ready_ms = k_uptime_get_32() - secured_at;
+  LOG_INF("ANCS ready %u ms after encryption", ready_ms);
 }
 
 static void discover_ancs_completed_cb(struct bt_gatt_dm* dm, void* ctx) {
@@ -96,6 +281,10 @@ static void discover_ancs_completed_cb(struct bt_gatt_dm* dm, void* ctx) {
   if (err) {
     LOG_ERR("Could not init ANCS client object, error: %d", err);
   } else {
+    uint16_t handles[GATT_CACHE_HANDLES] = {ancs_c->handle_cp, ancs_c->handle_ns, ancs_c->handle_ns_ccc,
+                                            ancs_c->handle_ds, ancs_c->handle_ds_ccc};
+
+    gatt_cache_set(bt_conn_get_dst(conn), GATT_CACHE_ANCS, handles);
     atomic_set_bit(&discovery_flags, DISCOVERY_ANCS_SUCCEEDED);
     enable_ancs_notifications(ancs_c);
   }
@@ -106,6 +295,7 @@ static void discover_ancs_completed_cb(struct bt_gatt_dm* dm, void* ctx) {
   }
 
   atomic_clear_bit(&discovery_flags, DISCOVERY_ANCS_ONGOING);
+  conn_params_demand(CONN_DEMAND_DISCOVERY, false);
   discover_ancs_again(conn);
 }
 
@@ -113,6 +303,7 @@ static void discover_ancs_not_found_cb(struct bt_conn* conn, void* ctx) {
   LOG_WRN("ANCS could not be found during the discovery");
 
   atomic_clear_bit(&discovery_flags, DISCOVERY_ANCS_ONGOING);
+  conn_params_demand(CONN_DEMAND_DISCOVERY, false);
   discover_ancs_again(conn);
 }
 
@@ -120,6 +311,7 @@ static void discover_ancs_error_found_cb(struct bt_conn* conn, int err, void* ct
   LOG_ERR("The discovery procedure for ANCS failed, err %d", err);
 
   atomic_clear_bit(&discovery_flags, DISCOVERY_ANCS_ONGOING);
+  conn_params_demand(CONN_DEMAND_DISCOVERY, false);
   discover_ancs_again(conn);
 }
 
@@ -131,6 +323,16 @@ static const struct bt_gatt_dm_cb discover_ancs_cb = {
 
 static void indicate_sc_cb(struct bt_gattp* gattp, const struct bt_gattp_handle_range* handle_range, int err) {
   if (!err) {
+    LOG_INF("Service Changed, handles 0x%04x-0x%04x", handle_range->start_handle, handle_range->end_handle);
+    gatt_cache_invalidate(bt_conn_get_dst(gattp->conn));
+
+    // ANCS may have moved: drop the subscriptions and find it again
+    if (atomic_test_and_clear_bit(&discovery_flags, DISCOVERY_ANCS_SUCCEEDED)) {
+      bt_ancs_unsubscribe_notification_source(&ancs_c);
+      bt_ancs_unsubscribe_data_source(&ancs_c);
+      ready_cached = false;
+      conn_params_demand(CONN_DEMAND_DISCOVERY, true);
+    }
     atomic_set_bit(&discovery_flags, SERVICE_CHANGED_INDICATED);
     discover_ancs_again(gattp->conn);
   }
@@ -159,6 +361,9 @@ static void discover_gattp_completed_cb(struct bt_gatt_dm* dm, void* ctx) {
     if (err) {
       LOG_ERR("Could not init GATT Service client object, error: %d", err);
     } else {
+      uint16_t handles[GATT_CACHE_HANDLES] = {gattp->handle_sc, gattp->handle_sc_ccc};
+
+      gatt_cache_set(bt_conn_get_dst(conn), GATT_CACHE_GATTP, handles);
       enable_gattp_indications(gattp);
     }
   } else {
@@ -197,6 +402,7 @@ static void discover_gattp(struct bt_conn* conn) {
   err = bt_gatt_dm_start(conn, BT_UUID_GATT, &discover_gattp_cb, &gattp);
   if (err) {
     LOG_ERR("Failed to start discovery for GATT Service (err %d)", err);
+    conn_params_demand(CONN_DEMAND_DISCOVERY, false);
   }
 }
 
@@ -226,6 +432,7 @@ static void discover_ancs(struct bt_conn* conn, bool retry) {
   if (err) {
     LOG_ERR("Failed to start discovery for ANCS (err %d)", err);
     atomic_clear_bit(&discovery_flags, DISCOVERY_ANCS_ONGOING);
+    conn_params_demand(CONN_DEMAND_DISCOVERY, false);
   }
 }
 
@@ -233,17 +440,135 @@ static void discover_ancs_first(struct bt_conn* conn) { discover_ancs(conn, fals
 
 static void discover_ancs_again(struct bt_conn* conn) { discover_ancs(conn, true); }
 
+static void fetch_reset(void) {
+  k_mutex_lock(&fetch_lock, K_FOREVER);
+  fetch_count = 0;
+  sync_count = 0;
+  sync_open = false;
+  k_work_cancel_delayable(&sync_work);
+  fetch_busy = false;
+  fetch_retries = 0;
+  k_work_cancel_delayable(&fetch_work);
+  k_mutex_unlock(&fetch_lock);
+  k_work_cancel_delayable(&resync_work);
+  conn_params_demand(CONN_DEMAND_ANCS, false);
+}
+
+/* The cached handles were wrong: forget them and discover as on a first connection */
+static void cache_check_work_fn(struct k_work* work) {
+  struct bt_conn* conn = ancs_c.conn;
+
+  if (!cache_unproven) {
+    return;
+  }
+  cache_unproven = false;
+  LOG_WRN("Cached ANCS handles do not hold, discovering");
+  gatt_cache_invalidate(bt_conn_get_dst(conn));
+  if (atomic_test_and_clear_bit(&discovery_flags, DISCOVERY_ANCS_SUCCEEDED)) {
+    bt_ancs_unsubscribe_notification_source(&ancs_c);
+    bt_ancs_unsubscribe_data_source(&ancs_c);
+  }
+  // Nothing came under the old handles, the session opens again after discovery
+  fetch_reset();
+  ready_cached = false;
+  conn_params_demand(CONN_DEMAND_DISCOVERY, true);
+  discover_gattp(conn);
+}
+
+static uint8_t cache_check_read_cb(struct bt_conn* conn, uint8_t err, struct bt_gatt_read_params* params,
+                                   const void* data, uint16_t length) {
+  bool subscribed = !err && data && length == sizeof(uint16_t) && (sys_get_le16(data) & BT_GATT_CCC_NOTIFY);
+
+  if (subscribed) {
+    cache_unproven = false;
+    k_work_cancel_delayable(&cache_check_work);
+  } else {
+    LOG_WRN("Notification Source CCC read back failed (err 0x%02x, %u bytes)", err, length);
+    k_work_reschedule(&cache_check_work, K_NO_WAIT);
+  }
+  return BT_GATT_ITER_STOP;
+}
+
+/* Queued behind the CCC writes of the subscriptions, so it reads their result */
+static void cache_check_start(struct bt_conn* conn) {
+  cache_unproven = true;
+  k_work_reschedule(&cache_check_work, K_MSEC(CACHE_CHECK_MS));
+
+  cache_check_params.func = cache_check_read_cb;
+  cache_check_params.handle_count = 1;
+  cache_check_params.single.handle = ancs_c.handle_ns_ccc;
+  cache_check_params.single.offset = 0;
+  int err = bt_gatt_read(conn, &cache_check_params);
+  if (err) {
+    LOG_WRN("Cannot read back Notification Source CCC (err %d)", err);
+    k_work_reschedule(&cache_check_work, K_NO_WAIT);
+  }
+}
+
+/*
+ * Reuse the handles found on an earlier connection to this phone. Both
+ * services must be cached: without the Service Changed subscription a moved
+ * ANCS would go unnoticed. bt_gattp_handles_assign() and
+ * bt_ancs_handles_assign() only take a discovery result, so the fields they
+ * fill are set here; cache_check_start() then proves the handles.
+ */
+static bool restore_handles(struct bt_conn* conn) {
+  const bt_addr_le_t* peer = bt_conn_get_dst(conn);
+  uint16_t sc[GATT_CACHE_HANDLES];
+  uint16_t ancs[GATT_CACHE_HANDLES];
+
+  if (gatt_cache_get(peer, GATT_CACHE_GATTP, sc) || gatt_cache_get(peer, GATT_CACHE_ANCS, ancs)) {
+    return false;
+  }
+  LOG_INF("GATT Service and ANCS handles from cache");
+
+  gattp.conn = conn;
+  gattp.handle_sc = sc[0];
+  gattp.handle_sc_ccc = sc[1];
+  enable_gattp_indications(&gattp);
+
+  ancs_c.conn = conn;
+  ancs_c.handle_cp = ancs[0];
+  ancs_c.handle_ns = ancs[1];
+  ancs_c.handle_ns_ccc = ancs[2];
+  ancs_c.handle_ds = ancs[3];
+  ancs_c.handle_ds_ccc = ancs[4];
+  atomic_set_bit(&discovery_flags, DISCOVERY_ANCS_SUCCEEDED);
+  enable_ancs_notifications(&ancs_c);
+  cache_check_start(conn);
+  return true;
+}
+
 static void security_changed(struct bt_conn* conn, bt_security_t level, enum bt_security_err err) {
   if (!err) {
     if (bt_conn_get_security(conn) >= BT_SECURITY_L2) {
       discovery_flags = ATOMIC_INIT(0);
+      fetch_reset();
+      secured_at = k_uptime_get_32();
+      ready_cached = restore_handles(conn);
+      if (ready_cached) {
+        return;
+      }
+      conn_params_demand(CONN_DEMAND_DISCOVERY, true);
       discover_gattp(conn);
     }
   }
 }
 
+/* A backlog cut short says nothing about what the phone still has */
+static void disconnected(struct bt_conn* conn, uint8_t reason) {
+  k_mutex_lock(&fetch_lock, K_FOREVER);
+  sync_open = false;
+  k_work_cancel_delayable(&sync_work);
+  k_mutex_unlock(&fetch_lock);
+  k_work_cancel_delayable(&resync_work);
+  cache_unproven = false;
+  k_work_cancel_delayable(&cache_check_work);
+}
+
 BT_CONN_CB_DEFINE(conn_callbacks) = {
     .security_changed = security_changed,
+    .disconnected = disconnected,
 };
 
 static void notif_print(const struct bt_ancs_evt_notif* notif) {
@@ -266,95 +591,471 @@ static void app_attr_print(const struct bt_ancs_attr* attr) {
   }
 }
 
-static void bt_ancs_notification_source_handler(struct bt_ancs_client* ancs_c, int err,
-                                                const struct bt_ancs_evt_notif* notif) {
-  if (!err && notif->evt_id == BT_ANCS_EVENT_ID_NOTIFICATION_ADDED) {
-    notification_latest = *notif;
-    notif_print(&notification_latest);
-
-    // Request notification attributes (content) for the new notification
-    int req_err = bt_ancs_request_attrs(ancs_c, notif, NULL);
-    if (req_err) {
-      LOG_ERR("Failed to request notification attributes (err %d)\n", req_err);
-    }
-    // Do not emit any event here
+/* Copy an attribute into a fixed field, truncating it */
+static void noti_attr_copy(char* dst, size_t size, const struct bt_ancs_attr* attr) {
+  size_t len = MIN(attr->attr_len, size - 1);
+
+  memcpy(dst, attr->attr_data, len);
+  dst[len] = '\0';
+}
+
+/* Hand app and title of a notification to the model */
+static void post_info(const ancs_noti_info_t* info) {
+  ancs_noti_info_t* info_ptr = event_payload_alloc(APP_EVENT_BLE_ANCS);
+
+  if (info_ptr == NULL) {
+    LOG_ERR("Failed to allocate memory for ANCS notification info");
+    return;
   }
+  *info_ptr = *info;
+
+  app_event_t event = {
+      .type = APP_EVENT_BLE_ANCS,
+      .ptr = info_ptr,
+      .len = sizeof(ancs_noti_info_t),
+  };
+  if (event_post(&event) < 0) {
+    event_payload_free(APP_EVENT_BLE_ANCS, info_ptr);
+    return;
+  }
+  ble_session_notified();
 }
 
-void ancs_noti_info_free(ancs_noti_info_t* noti) {
-  if (noti == NULL) {
+/* Hand the message of a notification to the model */
+static void post_body(uint32_t uid, const struct bt_ancs_attr* attr) {
+  ancs_noti_body_t* body = event_payload_alloc(APP_EVENT_BLE_ANCS_BODY);
+
+  if (body == NULL) {
+    LOG_ERR("Failed to allocate memory for ANCS message");
     return;
   }
-  if (noti->title) {
-    k_free(noti->title);
+  body->uid = uid;
+  noti_attr_copy(body->message, sizeof(body->message), attr);
+
+  app_event_t event = {
+      .type = APP_EVENT_BLE_ANCS_BODY,
+      .ptr = body,
+      .len = sizeof(*body),
+  };
+  if (event_post(&event) < 0) {
+    event_payload_free(APP_EVENT_BLE_ANCS_BODY, body);
   }
-  if (noti->message) {
-    k_free(noti->message);
+}
+
+static bool fetch_simulated(uint32_t uid) { return (uid & SIM_UID_MASK) == SIM_UID_BASE; }
+
+static void fetch_written(struct bt_ancs_client* ancs_c, uint8_t err);
+
+/* Remove queue entry @p i; the caller holds fetch_lock, as for all fetch_ functions */
+static void fetch_remove(uint8_t i) {
+  memmove(&fetch_queue[i], &fetch_queue[i + 1], (fetch_count - i - 1) * sizeof(fetch_queue[0]));
+  fetch_count--;
+}
+
+static void fetch_burst_begin(void) {
+  if (fetch_count == 0 && sync_count == 0) {
+    burst_start = k_uptime_get_32();
+    burst_notis = 0;
+    conn_params_demand(CONN_DEMAND_ANCS, true);
+  }
+}
+
+/* Note a notification to fetch in the background; a full backlog drops its oldest */
+static void sync_push(const struct fetch_req* req) {
+  for (uint8_t i = 0; i < sync_count; i++) {
+    if (sync_queue[i].uid == req->uid) {
+      sync_queue[i] = *req;
+      return;
+    }
   }
-  if (noti->app) {
-    k_free(noti->app);
+  fetch_burst_begin();
+  if (sync_count == SYNC_LEN) {
+    fetch_stats.dropped++;
+    memmove(&sync_queue[0], &sync_queue[1], (SYNC_LEN - 1) * sizeof(sync_queue[0]));
+    sync_count--;
   }
-  k_free(noti);
+  sync_queue[sync_count++] = *req;
 }
 
-static void bt_ancs_data_source_handler(struct bt_ancs_client* ancs_c, const struct bt_ancs_attr_response* response) {
-  static ancs_noti_info_t noti_info;
-  switch (response->command_id) {
-    case BT_ANCS_COMMAND_ID_GET_NOTIF_ATTRIBUTES: {
-      notif_attr_latest = response->attr;
-      notif_attr_print(&notif_attr_latest);
+/* Send the request at the front, else the oldest background one; a busy one is retried from fetch_work */
+static void fetch_issue(void) {
+  while (!fetch_busy) {
+    if (fetch_count == 0) {
+      if (sync_count == 0) {
+        conn_params_demand(CONN_DEMAND_ANCS, false);
+        break;
+      }
+      fetch_queue[fetch_count++] = sync_queue[0];
+      memmove(&sync_queue[0], &sync_queue[1], --sync_count * sizeof(sync_queue[0]));
+    }
 
-      uint16_t len = response->attr.attr_len;
-      char* str = NULL;
+    const struct fetch_req* req = &fetch_queue[0];
+    struct bt_ancs_evt_notif notif = {.notif_uid = req->uid};
+    int err = 0;
 
-      if (len > 0) {
-        str = k_malloc(len + 1);
-        if (str) {
-          memcpy(str, response->attr.attr_data, len);
-          str[len] = '\0';
+    if (fetch_simulated(req->uid)) {
+      k_work_reschedule(&sim_work, K_MSEC(sim_interval_ms));
+    } else {
+      for (int id = 0; id < BT_ANCS_NOTIF_ATTR_COUNT; id++) {
+        if (ancs_c.ancs_notif_attr_list[id].attr_data) {
+          ancs_c.ancs_notif_attr_list[id].get = (req->attrs & BIT(id)) != 0;
         }
       }
+      err = bt_ancs_request_attrs(&ancs_c, &notif, fetch_written);
+    }
 
-      if (response->attr.attr_id == BT_ANCS_NOTIF_ATTR_ID_APP_IDENTIFIER) {
-        if (noti_info.app) k_free(noti_info.app);
-        noti_info.app = str;
-      } else if (response->attr.attr_id == BT_ANCS_NOTIF_ATTR_ID_TITLE) {
-        if (noti_info.title) k_free(noti_info.title);
-        noti_info.title = str;
-      } else if (response->attr.attr_id == BT_ANCS_NOTIF_ATTR_ID_MESSAGE) {
-        if (noti_info.message) k_free(noti_info.message);
-        if (str && len > 256) {
-          str[256] = '\0';
-        }
-        noti_info.message = str;
-      } else {
-        if (str) k_free(str);
+    if ((err == -EBUSY || err == -ENOMEM) && fetch_retries < FETCH_MAX_RETRIES) {
+      fetch_retries++;
+      fetch_stats.retries++;
+      k_work_reschedule(&fetch_work, K_MSEC(FETCH_RETRY_MS));
+      return;
+    }
+    if (err) {
+      LOG_ERR("Failed to request attributes of %u (err %d)", req->uid, err);
+      fetch_retries = 0;
+      fetch_remove(0);
+      continue;
+    }
+
+    fetch_busy = true;
+    fetch_ctx = (struct fetch_ctx){
+        .uid = req->uid,
+        .attrs = req->attrs,
+        .info = {.uid = req->uid, .category = req->category, .flags = req->flags},
+    };
+    fetch_stats.requests++;
+    k_work_reschedule(&fetch_work, K_MSEC(FETCH_TIMEOUT_MS));
+  }
+}
+
+/* Post the head in flight */
+static void fetch_post_head(void) {
+  post_info(&fetch_ctx.info);
+  burst_notis++;
+  if (fetch_ctx.info.flags & (ANCS_NOTI_PRE_EXISTING | ANCS_NOTI_SILENT)) {
+    fetch_stats.synced++;
+  }
+}
+
+/*
+ * Show the app's display name rather than its identifier. On a cache miss the
+ * name is requested and the head stays in flight; returns true then.
+ */
+static bool fetch_app_name(void) {
+  ancs_noti_info_t* info = &fetch_ctx.info;
+  char name[ATTR_COMMON_SIZE];
+
+  if (fetch_ctx.app_id[0] == '\0' || fetch_simulated(fetch_ctx.uid)) {
+    return false;
+  }
+  // A cut identifier could collide in the cache and the phone would not know it
+  if (fetch_ctx.app_id_cut) {
+    LOG_WRN("App identifier %s... too long to name", fetch_ctx.app_id);
+    return false;
+  }
+  if (ancs_apps_lookup(fetch_ctx.app_id, name, sizeof(name))) {
+    if (name[0] != '\0') {
+      snprintf(info->app, sizeof(info->app), "%s", name);
+    }
+    return false;
+  }
+
+  int err =
+      bt_ancs_request_app_attr(&ancs_c, (const uint8_t*)fetch_ctx.app_id, strlen(fetch_ctx.app_id), fetch_written);
+  if (err) {
+    LOG_WRN("Failed to request the name of %s (err %d)", fetch_ctx.app_id, err);
+    return false;
+  }
+  fetch_ctx.naming = true;
+  fetch_stats.requests++;
+  k_work_reschedule(&fetch_work, K_MSEC(FETCH_TIMEOUT_MS));
+  return true;
+}
+
+/* Done with the request in flight, answered or not */
+static void fetch_advance(void) {
+  if (fetch_ctx.naming && !fetch_ctx.dropped) {
+    // Listed under its identifier if the name never came
+    fetch_post_head();
+    fetch_ctx.naming = false;
+  }
+  fetch_busy = false;
+  fetch_retries = 0;
+  fetch_remove(0);
+  fetch_issue();
+
+  if (fetch_count == 0) {
+    k_work_cancel_delayable(&fetch_work);
+    // Message fetches alone do not count as a burst
+    if (burst_notis > 0) {
+      app_event_t event = {.type = APP_EVENT_BLE_ANCS_IDLE};
+
+      fetch_stats.burst_notis = burst_notis;
+      fetch_stats.burst_ms = k_uptime_get_32() - burst_start;
+      LOG_INF("Fetched %u notifications in %u ms", burst_notis, fetch_stats.burst_ms);
+      // Under the lock, so it follows the last head
+      event_post(&event);
+    }
+  }
+}
+
+/* Queue position: messages first, then Important heads, then the others in arrival order */
+static uint8_t fetch_rank(const struct fetch_req* req) {
+  if (req->attrs == BODY_ATTRS) {
+    return 0;
+  }
+  return (req->flags & ANCS_NOTI_IMPORTANT) ? 1 : 2;
+}
+
+static int fetch_enqueue(const struct fetch_req* req) {
+  // Entry 0 stays put while it is in flight or waiting for a retry
+  uint8_t pos = fetch_count;
+
+  for (uint8_t i = 1; i < fetch_count; i++) {
+    if (fetch_queue[i].uid == req->uid && fetch_queue[i].attrs == req->attrs) {
+      return 0;
+    }
+    // Only the last opened message matters
+    if (req->attrs == BODY_ATTRS && fetch_queue[i].attrs == BODY_ATTRS) {
+      fetch_remove(i--);
+    }
+  }
+  if (fetch_count == FETCH_QUEUE_LEN) {
+    fetch_stats.dropped++;
+    LOG_WRN("Attribute request for %u dropped, queue full", req->uid);
+    return -ENOMEM;
+  }
+  while (pos > 1 && fetch_rank(&fetch_queue[pos - 1]) > fetch_rank(req)) {
+    pos--;
+  }
+  memmove(&fetch_queue[pos + 1], &fetch_queue[pos], (fetch_count - pos) * sizeof(fetch_queue[0]));
+  fetch_burst_begin();
+  fetch_queue[pos] = *req;
+  fetch_count++;
+  fetch_stats.peak = MAX(fetch_stats.peak, fetch_count);
+  fetch_issue();
+  return 0;
+}
+
+/*
+ * Removed by the phone. A request in flight still gets its response, which
+ * the client must parse before the next request goes out, so it is only
+ * marked dropped; one waiting for a retry is removed like the queued ones.
+ */
+static void fetch_cancel(uint32_t uid) {
+  if (fetch_busy && fetch_ctx.uid == uid) {
+    fetch_ctx.dropped = true;
+  }
+  for (uint8_t i = fetch_busy ? 1 : 0; i < fetch_count; i++) {
+    if (fetch_queue[i].uid == uid) {
+      if (i == 0) {
+        fetch_retries = 0;
       }
+      fetch_remove(i--);
+    }
+  }
+  for (uint8_t i = 0; i < sync_count; i++) {
+    if (sync_queue[i].uid == uid) {
+      memmove(&sync_queue[i], &sync_queue[i + 1], (sync_count - i - 1) * sizeof(sync_queue[0]));
+      sync_count--;
+      i--;
+    }
+  }
+}
 
-      // Post event after all three important fields are received
-      if (noti_info.title && noti_info.message && noti_info.app) {
-        ancs_noti_info_t* info_ptr = k_malloc(sizeof(ancs_noti_info_t));
-        if (info_ptr) {
-          *info_ptr = noti_info;
-          app_event_t event = {
-              .type = APP_EVENT_BLE_ANCS,
-              .ptr = info_ptr,
-              .len = sizeof(ancs_noti_info_t),
-          };
-          event_post(&event);
-        } else {
-          LOG_ERR("Failed to allocate memory for ANCS notification info\n");
-          if (noti_info.title) k_free(noti_info.title);
-          if (noti_info.message) k_free(noti_info.message);
-          if (noti_info.app) k_free(noti_info.app);
-        }
-        memset(&noti_info, 0, sizeof(noti_info));
+static void fetch_attr_received(const struct bt_ancs_attr_response* response, bool truncated) {
+  const struct bt_ancs_attr* attr = &response->attr;
+
+  k_mutex_lock(&fetch_lock, K_FOREVER);
+  if (!fetch_busy || response->notif_uid != fetch_ctx.uid || !(fetch_ctx.attrs & BIT(attr->attr_id))) {
+    LOG_DBG("Stale attribute %u of %u", attr->attr_id, response->notif_uid);
+    k_mutex_unlock(&fetch_lock);
+    return;
+  }
+
+  if (fetch_ctx.dropped) {
+    LOG_DBG("Attribute %u of removed %u", attr->attr_id, fetch_ctx.uid);
+  } else if (attr->attr_id == BT_ANCS_NOTIF_ATTR_ID_APP_IDENTIFIER) {
+    noti_attr_copy(fetch_ctx.app_id, sizeof(fetch_ctx.app_id), attr);
+    fetch_ctx.app_id_cut = truncated;
+    noti_attr_copy(fetch_ctx.info.app, sizeof(fetch_ctx.info.app), attr);
+  } else if (attr->attr_id == BT_ANCS_NOTIF_ATTR_ID_TITLE) {
+    noti_attr_copy(fetch_ctx.info.title, sizeof(fetch_ctx.info.title), attr);
+  } else if (attr->attr_id == BT_ANCS_NOTIF_ATTR_ID_MESSAGE) {
+    post_body(fetch_ctx.uid, attr);
+  }
+  fetch_ctx.received |= BIT(attr->attr_id);
+
+  // Complete: app and title go to the model, the message was posted as it came
+  if (fetch_ctx.received == fetch_ctx.attrs) {
+    if (fetch_ctx.attrs == HEAD_ATTRS && !fetch_ctx.dropped) {
+      if (fetch_app_name()) {
+        k_mutex_unlock(&fetch_lock);
+        return;
       }
-      break;
+      fetch_post_head();
     }
+    fetch_stats.completed++;
+    fetch_advance();
+  }
+  k_mutex_unlock(&fetch_lock);
+}
+
+/* Display name of the app of the head in flight; fetch_advance() posts the head */
+static void fetch_app_attr_received(const struct bt_ancs_attr_response* response) {
+  const struct bt_ancs_attr* attr = &response->attr;
+  char name[ATTR_COMMON_SIZE];
+
+  k_mutex_lock(&fetch_lock, K_FOREVER);
+  if (!fetch_busy || !fetch_ctx.naming || attr->attr_id != BT_ANCS_APP_ATTR_ID_DISPLAY_NAME) {
+    LOG_DBG("Stale app attribute %u", attr->attr_id);
+    k_mutex_unlock(&fetch_lock);
+    return;
+  }
+
+  noti_attr_copy(name, sizeof(name), attr);
+  ancs_apps_store(fetch_ctx.app_id, name);
+  if (name[0] != '\0') {
+    snprintf(fetch_ctx.info.app, sizeof(fetch_ctx.info.app), "%s", name);
+  }
+  fetch_stats.completed++;
+  fetch_advance();
+  k_mutex_unlock(&fetch_lock);
+}
+
+/* The phone rejects requests for unknown UIDs, no response follows */
+static void fetch_written(struct bt_ancs_client* ancs_c, uint8_t err) {
+  if (err) {
+    LOG_WRN("Attribute request rejected (ATT err 0x%02x)", err);
+    k_mutex_lock(&fetch_lock, K_FOREVER);
+    if (fetch_busy) {
+      fetch_stats.rejected++;
+      fetch_advance();
+    }
+    k_mutex_unlock(&fetch_lock);
+  }
+}
+
+/* Retry a busy request, or give up on one the phone never completed */
+static void fetch_work_fn(struct k_work* work) {
+  k_mutex_lock(&fetch_lock, K_FOREVER);
+  if (fetch_busy) {
+    LOG_WRN("No complete response for %u", fetch_ctx.uid);
+    fetch_stats.timeouts++;
+    fetch_advance();
+  } else {
+    fetch_issue();
+  }
+  k_mutex_unlock(&fetch_lock);
+}
+
+/* Tell the model the backlog is in once it has settled and every head was posted */
+static void sync_work_fn(struct k_work* work) {
+  k_mutex_lock(&fetch_lock, K_FOREVER);
+  // Nothing may be dropped on the word of handles that are not proven yet
+  if (sync_open && (fetch_count > 0 || sync_count > 0 || cache_unproven)) {
+    k_work_reschedule(&sync_work, K_MSEC(SYNC_SETTLE_MS));
+  } else if (sync_open) {
+    app_event_t event = {.type = APP_EVENT_BLE_ANCS_SYNCED};
+
+    // Posted under the lock, so it follows the last head
+    sync_open = event_post(&event) < 0;
+    if (sync_open) {
+      k_work_reschedule(&sync_work, K_MSEC(SYNC_SETTLE_MS));
+    }
+  }
+  k_mutex_unlock(&fetch_lock);
+}
+
+void ancs_client_set_categories(uint16_t mask) {
+  categories = mask & CATEGORIES_ALL;
+#ifdef CONFIG_SETTINGS
+  int err = settings_save_one("ancs/categories", &categories, sizeof(categories));
+  if (err) {
+    LOG_ERR("Failed to save category filter (err %d)", err);
+  }
+#endif
+}
+
+uint16_t ancs_client_get_categories(void) { return categories; }
+
+#ifdef CONFIG_SETTINGS
+static int ancs_settings_set(const char* name, size_t len, settings_read_cb read_cb, void* cb_arg) {
+  if (settings_name_steq(name, "categories", NULL) && len == sizeof(categories)) {
+    return read_cb(cb_arg, &categories, sizeof(categories)) < 0 ? -EIO : 0;
+  }
+  return -ENOENT;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(ancs, "ancs", NULL, ancs_settings_set, NULL, NULL);
+#endif
+
+int ancs_client_request_message(uint32_t uid) {
+  int err;
+
+  if (!atomic_test_bit(&discovery_flags, DISCOVERY_ANCS_SUCCEEDED) && !fetch_simulated(uid)) {
+    return -ENOTCONN;
+  }
+
+  struct fetch_req req = {.uid = uid, .attrs = BODY_ATTRS};
+
+  k_mutex_lock(&fetch_lock, K_FOREVER);
+  err = fetch_enqueue(&req);
+  k_mutex_unlock(&fetch_lock);
+  return err;
+}
+
+/* Added, Modified or Removed, on ancs_wq after every attribute that arrived before it */
+static void notif_process(const struct bt_ancs_evt_notif* notif) {
+  notification_latest = *notif;
+  notif_print(&notification_latest);
+
+  struct fetch_req req = {
+      .uid = notif->notif_uid,
+      .attrs = HEAD_ATTRS,
+      .category = notif->category_id < BT_ANCS_CATEGORY_ID_COUNT ? notif->category_id : BT_ANCS_CATEGORY_ID_OTHER,
+      .flags = (notif->evt_flags.silent ? ANCS_NOTI_SILENT : 0) |
+               (notif->evt_flags.important ? ANCS_NOTI_IMPORTANT : 0) |
+               (notif->evt_flags.pre_existing ? ANCS_NOTI_PRE_EXISTING : 0),
+  };
+
+  k_mutex_lock(&fetch_lock, K_FOREVER);
+  if (notif->evt_id == BT_ANCS_EVENT_ID_NOTIFICATION_REMOVED) {
+    fetch_cancel(notif->notif_uid);
+  } else if (!(req.flags & ANCS_NOTI_IMPORTANT) && !(categories & BIT(req.category))) {
+    fetch_stats.filtered++;
+  } else if (req.flags & (ANCS_NOTI_PRE_EXISTING | ANCS_NOTI_SILENT)) {
+    sync_push(&req);
+    fetch_issue();
+    if (sync_open && (req.flags & ANCS_NOTI_PRE_EXISTING)) {
+      k_work_reschedule(&sync_work, K_MSEC(SYNC_SETTLE_MS));
+    }
+  } else {
+    // Added or modified: request app and title, the model matches the UID when they arrive
+    fetch_enqueue(&req);
+  }
+  k_mutex_unlock(&fetch_lock);
+
+  if (notif->evt_id == BT_ANCS_EVENT_ID_NOTIFICATION_REMOVED) {
+    app_event_t event = {
+        .type = APP_EVENT_BLE_ANCS_REMOVED,
+        .value = notif->notif_uid,
+    };
+    event_post(&event);
+  }
+}
+
+static void attr_process(const struct bt_ancs_attr_response* response, bool truncated) {
+  switch (response->command_id) {
+    case BT_ANCS_COMMAND_ID_GET_NOTIF_ATTRIBUTES:
+      notif_attr_latest = response->attr;
+      notif_attr_print(&notif_attr_latest);
+      fetch_attr_received(response, truncated);
+      break;
 
     case BT_ANCS_COMMAND_ID_GET_APP_ATTRIBUTES:
       app_attr_print(&response->attr);
+      fetch_app_attr_received(response);
       break;
 
     default:
@@ -363,68 +1064,202 @@ static void bt_ancs_data_source_handler(struct bt_ancs_client* ancs_c, const str
   }
 }
 
-static int ancs_c_init(void) {
-  int err;
+/*
+ * A dropped Added is never listed and a dropped Removed leaves its entry
+ * behind. Drop the subscription and take it again: the phone replays all it
+ * still has as PreExisting, the model keeps what is replayed and drops the rest.
+ */
+static void resync_start(void) {
+  LOG_WRN("ANCS events lost, resyncing");
+  fetch_reset();
+  if (atomic_test_bit(&discovery_flags, DISCOVERY_ANCS_SUCCEEDED)) {
+    bt_ancs_unsubscribe_notification_source(&ancs_c);
+    k_work_reschedule_for_queue(&ancs_wq, &resync_work, K_MSEC(RESYNC_DELAY_MS));
+  }
+}
 
-  err = bt_ancs_client_init(&ancs_c);
+/* On ancs_wq, so no record of the old session is in process */
+static void resync_work_fn(struct k_work* work) {
+  k_spinlock_key_t key = k_spin_lock(&rx_lock);
+
+  // Whatever came in since belongs to the old session and will be replayed
+  ring_buf_reset(&ancs_rx_ring);
+  rx_lost = false;
+  rx_stats.resyncs++;
+  k_spin_unlock(&rx_lock, key);
+
+  if (!atomic_test_bit(&discovery_flags, DISCOVERY_ANCS_SUCCEEDED)) {
+    return;
+  }
+  session_open();
+  int err = bt_ancs_subscribe_notification_source(&ancs_c, bt_ancs_notification_source_handler);
   if (err) {
-    return err;
+    LOG_ERR("Failed to enable Notification Source notification (err %d)", err);
   }
+}
 
-  err = bt_ancs_register_attr(&ancs_c, BT_ANCS_NOTIF_ATTR_ID_APP_IDENTIFIER, &attr_bufs.app_id[0],
-                              sizeof(attr_bufs.app_id));
-  if (err) {
-    return err;
+/* Drain ancs_rx_ring on ancs_wq */
+static void rx_work_fn(struct k_work* work) {
+  static uint8_t data[ATTR_MESSAGE_SIZE + 1];  // NUL-terminated for the log
+
+  for (;;) {
+    struct rx_rec rec;
+    k_spinlock_key_t key = k_spin_lock(&rx_lock);
+
+    if (ring_buf_size_get(&ancs_rx_ring) < sizeof(rec)) {
+      bool lost = rx_lost;
+
+      rx_lost = false;
+      k_spin_unlock(&rx_lock, key);
+      if (lost) {
+        resync_start();
+      }
+      break;
+    }
+    // The callbacks put whole records, so the data follows its header
+    ring_buf_get(&ancs_rx_ring, (uint8_t*)&rec, sizeof(rec));
+    ring_buf_get(&ancs_rx_ring, data, rec.len);
+    k_spin_unlock(&rx_lock, key);
+    data[rec.len] = '\0';
+
+    uint32_t start = k_cycle_get_32();
+
+    if (rec.kind == RX_NOTIF) {
+      struct bt_ancs_evt_notif notif;
+
+      memcpy(&notif, data, sizeof(notif));
+      notif_process(&notif);
+    } else {
+      struct bt_ancs_attr_response response = {
+          .command_id = rec.command_id,
+          .notif_uid = rec.uid,
+          .attr = {.attr_id = rec.attr_id, .attr_len = rec.len, .attr_data = data},
+      };
+
+      attr_process(&response, rec.truncated);
+    }
+    rx_stats.work_max_cyc = MAX(rx_stats.work_max_cyc, k_cycle_get_32() - start);
   }
+}
 
-  err = bt_ancs_register_app_attr(&ancs_c, BT_ANCS_APP_ATTR_ID_DISPLAY_NAME, attr_bufs.disp_name,
-                                  sizeof(attr_bufs.disp_name));
-  if (err) {
-    return err;
+/* Bluetooth RX thread: copy the record and hand it to ancs_wq, nothing else */
+static void rx_put(const struct rx_rec* rec, const void* data) {
+  uint32_t start = k_cycle_get_32();
+  k_spinlock_key_t key = k_spin_lock(&rx_lock);
+
+  if (ring_buf_space_get(&ancs_rx_ring) >= sizeof(*rec) + rec->len) {
+    ring_buf_put(&ancs_rx_ring, (const uint8_t*)rec, sizeof(*rec));
+    ring_buf_put(&ancs_rx_ring, data, rec->len);
+    rx_stats.records++;
+    rx_stats.peak = MAX(rx_stats.peak, ring_buf_size_get(&ancs_rx_ring));
+  } else {
+    rx_stats.overflows++;
+    rx_lost |= rec->kind == RX_NOTIF;
   }
+  k_spin_unlock(&rx_lock, key);
 
-  err = bt_ancs_register_attr(&ancs_c, BT_ANCS_NOTIF_ATTR_ID_TITLE, attr_bufs.title, sizeof(attr_bufs.title));
-  if (err) {
-    return err;
+  k_work_submit_to_queue(&ancs_wq, &rx_work);
+  rx_stats.cb_max_cyc = MAX(rx_stats.cb_max_cyc, k_cycle_get_32() - start);
+}
+
+static void bt_ancs_notification_source_handler(struct bt_ancs_client* ancs_c, int err,
+                                                const struct bt_ancs_evt_notif* notif) {
+  struct rx_rec rec = {.uid = notif->notif_uid, .kind = RX_NOTIF, .len = sizeof(*notif)};
+
+  if (!err) {
+    rx_put(&rec, notif);
   }
+}
 
-  err = bt_ancs_register_attr(&ancs_c, BT_ANCS_NOTIF_ATTR_ID_MESSAGE, attr_bufs.message, sizeof(attr_bufs.message));
+/*
+ * The client reports the length the phone announced but keeps at most the
+ * registered buffer, NUL-terminated; copy only what it kept.
+ */
+static void bt_ancs_data_source_handler(struct bt_ancs_client* ancs_c, const struct bt_ancs_attr_response* response) {
+  const struct bt_ancs_attr_list* list = response->command_id == BT_ANCS_COMMAND_ID_GET_APP_ATTRIBUTES
+                                             ? &ancs_c->ancs_app_attr_list[response->attr.attr_id]
+                                             : &ancs_c->ancs_notif_attr_list[response->attr.attr_id];
+  uint16_t held = list->attr_len > 0 ? MIN(list->attr_len - 1, ATTR_MESSAGE_SIZE) : 0;
+  struct rx_rec rec = {
+      .uid = response->notif_uid,
+      .kind = RX_ATTR,
+      .command_id = response->command_id,
+      .attr_id = response->attr.attr_id,
+      .truncated = response->attr.attr_len > held,
+      .len = MIN(response->attr.attr_len, held),
+  };
+
+  rx_put(&rec, response->attr.attr_data);
+}
+
+/* Answer the request in flight the way the phone would */
+static void sim_work_fn(struct k_work* work) {
+  static char text[ATTR_TITLE_SIZE];
+  struct bt_ancs_attr_response response = {.command_id = BT_ANCS_COMMAND_ID_GET_NOTIF_ATTRIBUTES};
+  uint8_t attrs;
+
+  k_mutex_lock(&fetch_lock, K_FOREVER);
+  response.notif_uid = fetch_ctx.uid;
+  attrs = fetch_busy ? fetch_ctx.attrs : 0;
+  k_mutex_unlock(&fetch_lock);
+
+  for (int id = 0; id < BT_ANCS_NOTIF_ATTR_COUNT; id++) {
+    if (!(attrs & BIT(id))) {
+      continue;
+    }
+    snprintf(text, sizeof(text), "%s %u",
+             id == BT_ANCS_NOTIF_ATTR_ID_APP_IDENTIFIER ? "sim"
+             : id == BT_ANCS_NOTIF_ATTR_ID_TITLE        ? "Simulated"
+                                                        : "Simulated message",
+             response.notif_uid - SIM_UID_BASE);
+    response.attr = (struct bt_ancs_attr){.attr_id = id, .attr_len = strlen(text), .attr_data = (uint8_t*)text};
+    bt_ancs_data_source_handler(&ancs_c, &response);
+  }
+}
+
+static int ancs_c_init(void) {
+  int err;
+
+  err = bt_ancs_client_init(&ancs_c);
   if (err) {
     return err;
   }
 
-  err = bt_ancs_register_attr(&ancs_c, BT_ANCS_NOTIF_ATTR_ID_SUBTITLE, attr_bufs.subtitle, sizeof(attr_bufs.subtitle));
+  err = bt_ancs_register_attr(&ancs_c, BT_ANCS_NOTIF_ATTR_ID_APP_IDENTIFIER, &attr_bufs.app_id[0],
+                              sizeof(attr_bufs.app_id));
   if (err) {
     return err;
   }
 
-  err = bt_ancs_register_attr(&ancs_c, BT_ANCS_NOTIF_ATTR_ID_MESSAGE_SIZE, attr_bufs.message_size,
-                              sizeof(attr_bufs.message_size));
+  err = bt_ancs_register_app_attr(&ancs_c, BT_ANCS_APP_ATTR_ID_DISPLAY_NAME, attr_bufs.disp_name,
+                                  sizeof(attr_bufs.disp_name));
   if (err) {
     return err;
   }
 
-  err = bt_ancs_register_attr(&ancs_c, BT_ANCS_NOTIF_ATTR_ID_DATE, attr_bufs.date, sizeof(attr_bufs.date));
+  err = bt_ancs_register_attr(&ancs_c, BT_ANCS_NOTIF_ATTR_ID_TITLE, attr_bufs.title, sizeof(attr_bufs.title));
   if (err) {
     return err;
   }
 
-  err = bt_ancs_register_attr(&ancs_c, BT_ANCS_NOTIF_ATTR_ID_POSITIVE_ACTION_LABEL, attr_bufs.posaction,
-                              sizeof(attr_bufs.posaction));
+  err = bt_ancs_register_attr(&ancs_c, BT_ANCS_NOTIF_ATTR_ID_MESSAGE, attr_bufs.message, sizeof(attr_bufs.message));
   if (err) {
     return err;
   }
 
-  err = bt_ancs_register_attr(&ancs_c, BT_ANCS_NOTIF_ATTR_ID_NEGATIVE_ACTION_LABEL, attr_bufs.negaction,
-                              sizeof(attr_bufs.negaction));
+  // Only requested when a notification is opened, see fetch_issue()
+  ancs_c.ancs_notif_attr_list[BT_ANCS_NOTIF_ATTR_ID_MESSAGE].get = false;
 
-  return err;
+  return 0;
 }
 
 static int gattp_init(void) { return bt_gattp_init(&gattp); }
 
 int ancs_client_init(void) {
   int err;
+  const struct k_work_queue_config wq_cfg = {.name = "ancs_wq"};
+
+  k_work_queue_start(&ancs_wq, ancs_wq_stack, K_THREAD_STACK_SIZEOF(ancs_wq_stack), ANCS_WQ_PRIORITY, &wq_cfg);
 
   err = ancs_c_init();
   if (err) {
@@ -440,3 +1275,124 @@ int ancs_client_init(void) {
 
   return 0;
 }
+
+#ifdef CONFIG_SHELL
+
+#define SIM_BURST_DEFAULT 16
+#define SIM_WAIT_MS 10000
+
+static void print_burst(const struct shell* sh, uint32_t notis, uint32_t ms) {
+  if (notis == 0 || ms == 0) {
+    return;
+  }
+  uint32_t rate10 = notis * 10000 / ms;
+  shell_print(sh, "Burst: %u notifications in %u ms, %u.%u per second", notis, ms, rate10 / 10, rate10 % 10);
+}
+
+static int cmd_ancs(const struct shell* sh, size_t argc, char** argv) {
+  struct fetch_stats s;
+  struct rx_stats a;
+
+  k_mutex_lock(&fetch_lock, K_FOREVER);
+  s = fetch_stats;
+  k_mutex_unlock(&fetch_lock);
+  k_spinlock_key_t key = k_spin_lock(&rx_lock);
+  a = rx_stats;
+  k_spin_unlock(&rx_lock, key);
+
+  shell_print(sh, "requests %u  completed %u  retries %u  timeouts %u  rejected %u  dropped %u  peak depth %u/%u",
+              s.requests, s.completed, s.retries, s.timeouts, s.rejected, s.dropped, s.peak, FETCH_QUEUE_LEN);
+  shell_print(sh, "filtered %u  synced in background %u", s.filtered, s.synced);
+  shell_print(sh, "notification and data source: %u records, %u dropped, %u resyncs, ring peak %u/%u B", a.records,
+              a.overflows, a.resyncs, a.peak, (unsigned int)RX_RING_SIZE);
+  shell_print(sh, "worst case: callback %u us, deferred processing %u us per record",
+              k_cyc_to_us_floor32(a.cb_max_cyc), k_cyc_to_us_floor32(a.work_max_cyc));
+  print_burst(sh, s.burst_notis, s.burst_ms);
+  shell_print(sh, "ready %u ms after encryption, handles %s", ready_ms, ready_cached ? "cached" : "discovered");
+  return 0;
+}
+
+static int cmd_ancs_apps(const struct shell* sh, size_t argc, char** argv) {
+  struct ancs_apps_stats s;
+  struct ancs_app app;
+
+  ancs_apps_stats_get(&s);
+  for (uint8_t i = 0; ancs_apps_get(i, &app); i++) {
+    shell_print(sh, "%-32s %s", app.id, app.name[0] ? app.name : "(none)");
+  }
+  shell_print(sh, "%u/%u apps, %u hits, %u misses", s.count, ANCS_APPS_LEN, s.hits, s.misses);
+  return 0;
+}
+
+/* Inject Added notifications as if the phone sent them at once, answered by sim_work_fn() */
+static int sim_burst(const struct shell* sh, size_t argc, char** argv, bool pre_existing) {
+  static uint32_t sim_uid = SIM_UID_BASE;
+  int n = argc > 1 ? atoi(argv[1]) : SIM_BURST_DEFAULT;
+  bool idle;
+
+  if (argc > 2) {
+    sim_interval_ms = atoi(argv[2]);
+  }
+
+  k_mutex_lock(&fetch_lock, K_FOREVER);
+  idle = fetch_count == 0 && sync_count == 0;
+  k_mutex_unlock(&fetch_lock);
+  if (!idle) {
+    shell_error(sh, "Attribute requests in flight");
+    return -EBUSY;
+  }
+
+  for (int i = 0; i < n; i++) {
+    struct bt_ancs_evt_notif notif = {
+        .evt_id = BT_ANCS_EVENT_ID_NOTIFICATION_ADDED,
+        .evt_flags.pre_existing = pre_existing,
+        .category_id = BT_ANCS_CATEGORY_ID_SOCIAL,
+        .notif_uid = sim_uid++,
+    };
+    bt_ancs_notification_source_handler(&ancs_c, 0, &notif);
+  }
+
+  for (int waited = 0; !idle && waited < SIM_WAIT_MS; waited += 10) {
+    k_msleep(10);
+    k_mutex_lock(&fetch_lock, K_FOREVER);
+    idle = fetch_count == 0 && sync_count == 0;
+    k_mutex_unlock(&fetch_lock);
+  }
+  if (!idle) {
+    shell_error(sh, "Burst not done after %d ms", SIM_WAIT_MS);
+    return -ETIMEDOUT;
+  }
+  k_mutex_lock(&fetch_lock, K_FOREVER);
+  print_burst(sh, fetch_stats.burst_notis, fetch_stats.burst_ms);
+  k_mutex_unlock(&fetch_lock);
+  return 0;
+}
+
+static int cmd_ancs_burst(const struct shell* sh, size_t argc, char** argv) { return sim_burst(sh, argc, argv, false); }
+
+/* The backlog the phone replays on connection */
+static int cmd_ancs_backlog(const struct shell* sh, size_t argc, char** argv) {
+  return sim_burst(sh, argc, argv, true);
+}
+
+static int cmd_ancs_categories(const struct shell* sh, size_t argc, char** argv) {
+  if (argc > 1) {
+    ancs_client_set_categories(strtoul(argv[1], NULL, 0));
+  }
+  for (int i = 0; i < BT_ANCS_CATEGORY_ID_COUNT; i++) {
+    shell_print(sh, "%2d %-22s %s", i, lit_catid[i], (categories & BIT(i)) ? "listed" : "filtered");
+  }
+  return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(
+    ancs_cmds,
+    SHELL_CMD_ARG(burst, NULL, "[n] [interval ms] Simulate a burst of notifications", cmd_ancs_burst, 1, 2),
+    SHELL_CMD_ARG(backlog, NULL, "[n] [interval ms] Simulate the backlog replayed on connection", cmd_ancs_backlog,
+                  1, 2),
+    SHELL_CMD_ARG(categories, NULL, "[mask] Show or set the listed categories", cmd_ancs_categories, 1, 1),
+    SHELL_CMD(apps, NULL, "Cached app display names", cmd_ancs_apps),
+    SHELL_SUBCMD_SET_END);
+SHELL_SUBCMD_ADD((diag), ancs, &ancs_cmds, "ANCS attribute request queue", cmd_ancs, 1, 0);
+
+#endif  // CONFIG_SHELL
@@ -1,26 +1,49 @@
 #ifndef ANCS_CLIENT_H
 #define ANCS_CLIENT_H
 
-#include <bluetooth/services/ancs_client.h>
-#include <zephyr/bluetooth/conn.h>
-
-/* Allocated size for attribute data. */
-#define ATTR_DATA_SIZE BT_ANCS_ATTR_DATA_MAX
+#include <stdint.h>
+#include <zephyr/sys/util.h>
 
 #define ATTR_TITLE_SIZE 64
 #define ATTR_MESSAGE_SIZE 256
-#define ATTR_APP_ID_SIZE 32
+#define ATTR_APP_ID_SIZE 32  // display copy in ancs_noti_info_t
+#define ATTR_APP_ID_MAX 64   // whole App Identifier, the key for app names
 #define ATTR_COMMON_SIZE 32
 
-/* Struct for notification info */
+/* ancs_noti_info_t flags, from the ANCS EventFlags */
+#define ANCS_NOTI_SILENT BIT(0)
+#define ANCS_NOTI_IMPORTANT BIT(1)
+#define ANCS_NOTI_PRE_EXISTING BIT(2)  // replayed by the phone on (re)connection
+
+/* Struct for notification info, NUL-terminated and truncated to fit */
 typedef struct {
-  char* title;
-  char* message;
-  char* app;
+  uint32_t uid;
+  uint8_t category;  // ANCS CategoryID
+  uint8_t flags;     // ANCS_NOTI_*
+  char title[ATTR_TITLE_SIZE];
+  char app[ATTR_APP_ID_SIZE];
 } ancs_noti_info_t;
 
-void ancs_noti_info_free(ancs_noti_info_t* noti);
+/* Message of a notification, fetched on request */
+typedef struct {
+  uint32_t uid;
+  char message[ATTR_MESSAGE_SIZE];
+} ancs_noti_body_t;
 
 int ancs_client_init(void);
 
+/**
+ * @brief Choose the notification categories that are listed, BIT() of the
+ * ANCS CategoryIDs; saved in settings. Important notifications are always
+ * listed.
+ */
+void ancs_client_set_categories(uint16_t mask);
+uint16_t ancs_client_get_categories(void);
+
+/**
+ * @brief Fetch the message of notification @p uid. It arrives as an
+ * APP_EVENT_BLE_ANCS_BODY event; waits for a request in flight to finish.
+ */
+int ancs_client_request_message(uint32_t uid);
+
 #endif  // ANCS_CLIENT_H
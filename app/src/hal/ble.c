@@ -3,6 +3,7 @@
 #include <bluetooth/services/ancs_client.h>
 #include <bluetooth/services/cts_client.h>
 #include <stdio.h>
+#include <string.h>
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/bluetooth/conn.h>
 #include <zephyr/bluetooth/gatt.h>
@@ -10,22 +11,77 @@
 #include <zephyr/bluetooth/uuid.h>
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
-#include <zephyr/drivers/flash.h>
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/settings/settings.h>
-#include <zephyr/storage/flash_map.h>
-#include <zephyr/sys/reboot.h>
+#include <zephyr/shell/shell.h>
 
 #include "ancs_client.h"
 #include "cts_client.h"
+#include "gatt_cache.h"
 
 LOG_MODULE_REGISTER(ble);
 
 #define DEVICE_NAME CONFIG_BT_DEVICE_NAME
 #define DEVICE_NAME_LEN (sizeof(DEVICE_NAME) - 1)
 
-static struct k_work adv_work;
+/*
+ * Advertising runs in stages so that it costs little when no phone comes:
+ * fast after boot, a link loss or a button press, then slow, then deep idle,
+ * which is very slow while there is a bond for the phone to come back to and
+ * off otherwise. Bonds survive disconnects; while there is one, the fast
+ * stage admits the bonded phone only (filter accept list; the controller
+ * resolves the phone's private address with the bond's IRK). Later stages
+ * admit anyone, so a phone that forgot the bond can pair again, unless
+ * "diag ble bonded on" keeps them bonded-only too.
+ */
+enum adv_stage { ADV_STAGE_FAST, ADV_STAGE_SLOW, ADV_STAGE_DEEP, ADV_STAGE_OFF, ADV_STAGE_COUNT };
+
+struct adv_stage_def {
+  const char* name;
+  uint16_t interval_min;  // 0.625 ms units
+  uint16_t interval_max;
+  uint32_t duration_s;  // 0: until a connection or a button press
+};
+
+static const struct adv_stage_def adv_stages[ADV_STAGE_COUNT] = {
+    [ADV_STAGE_FAST] = {"fast", BT_GAP_ADV_FAST_INT_MIN_2, BT_GAP_ADV_FAST_INT_MAX_2, 30},  // 100-150 ms
+    [ADV_STAGE_SLOW] = {"slow", BT_GAP_ADV_SLOW_INT_MIN, BT_GAP_ADV_SLOW_INT_MAX, 300},     // 1-1.2 s
+    [ADV_STAGE_DEEP] = {"deep", 0x1F40, 0x2260, 0},                                         // 5-5.5 s
+    [ADV_STAGE_OFF] = {"off"},
+};
+
+/*
+ * Duty cycle estimate: radio time of one connectable advertising event (three
+ * channels, each a TX and the window for a request), and the mean random
+ * delay the controller adds to each interval.
+ */
+#define ADV_EVENT_US 1500
+#define ADV_DELAY_US 5000
+
+/* Link loss to reconnection, and reconnection to the first notification */
+struct ble_stats {
+  uint32_t reconnects;
+  uint32_t reconnect_ms;
+  uint32_t reconnect_max_ms;
+  uint32_t first_noti_ms;
+  uint32_t first_noti_max_ms;
+};
+
+static struct k_work adv_work;                  // restart at the fast stage
+static struct k_work_delayable adv_stage_work;  // next stage
+static struct k_spinlock adv_lock;              // adv_stage accounting
+static enum adv_stage adv_stage = ADV_STAGE_OFF;
+static uint32_t adv_stage_since;
+static uint32_t adv_ms[ADV_STAGE_COUNT];  // time per stage
+static bool adv_open;                     // the fast stage is over, admit anyone
+static bool adv_bonded_only;              // saved as "ble/bonded_only"
+static bool link_up;
+static bool link_lost;
+static uint32_t link_lost_at;  // k_uptime_get_32()
+static uint32_t connected_at;
+static bool awaiting_noti;
+static struct ble_stats ble_stats;
 
 static const struct bt_data ad[] = {
     BT_DATA_BYTES(BT_DATA_FLAGS, (BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR)),
@@ -37,31 +93,88 @@ static const struct bt_data sd[] = {
     BT_DATA(BT_DATA_NAME_COMPLETE, DEVICE_NAME, DEVICE_NAME_LEN),
 };
 
-static void clear_all_settings() {
-#define TEST_PARTITION storage_partition
-#define TEST_PARTITION_OFFSET FIXED_PARTITION_OFFSET(TEST_PARTITION)
-#define TEST_PARTITION_DEVICE FIXED_PARTITION_DEVICE(TEST_PARTITION)
-#define TEST_PARTITION_SIZE FIXED_PARTITION_SIZE(TEST_PARTITION)
+static void count_bond(const struct bt_bond_info* info, void* user_data) { (*(int*)user_data)++; }
 
-  if (flash_erase(TEST_PARTITION_DEVICE, TEST_PARTITION_OFFSET, TEST_PARTITION_SIZE) != 0) {
-    LOG_ERR("Failed to erase flash partition");
-  } else {
-    LOG_INF("Successfully erased flash partition");
+static void add_bond(const struct bt_bond_info* info, void* user_data) {
+  int* bonds = user_data;
+
+  if (bt_le_filter_accept_list_add(&info->addr) == 0) {
+    (*bonds)++;
   }
 }
 
-static void adv_work_handler(struct k_work* work) {
+/* Charge the time spent in the current stage and enter @p stage */
+static void adv_stage_set(enum adv_stage stage) {
+  k_spinlock_key_t key = k_spin_lock(&adv_lock);
+  uint32_t now = k_uptime_get_32();
+
+  adv_ms[adv_stage] += now - adv_stage_since;
+  adv_stage_since = now;
+  adv_stage = stage;
+  k_spin_unlock(&adv_lock, key);
+}
+
+static void adv_run(enum adv_stage stage) {
+  uint32_t options = BT_LE_ADV_OPT_CONN;
+  int bonded = 0;
+  int filtered = 0;
   int err;
 
-  ARG_UNUSED(work);
+  // The accept list cannot change while advertising uses it
+  bt_le_adv_stop();
+  if (link_up) {
+    return;
+  }
+
+  bt_foreach_bond(BT_ID_DEFAULT, count_bond, &bonded);
+  if (stage == ADV_STAGE_DEEP && bonded == 0) {
+    stage = ADV_STAGE_OFF;
+  }
+  if (stage == ADV_STAGE_OFF) {
+    adv_stage_set(ADV_STAGE_OFF);
+    LOG_INF("Advertising stopped until a button press");
+    return;
+  }
+
+  if (bonded && (!adv_open || adv_bonded_only)) {
+    bt_le_filter_accept_list_clear();
+    bt_foreach_bond(BT_ID_DEFAULT, add_bond, &filtered);
+  }
+  if (filtered) {
+    options |= BT_LE_ADV_OPT_FILTER_CONN | BT_LE_ADV_OPT_FILTER_SCAN_REQ;
+  }
 
-  err = bt_le_adv_start(BT_LE_ADV_CONN_FAST_2, ad, ARRAY_SIZE(ad), sd, ARRAY_SIZE(sd));
+  const struct adv_stage_def* def = &adv_stages[stage];
+  const struct bt_le_adv_param param = BT_LE_ADV_PARAM_INIT(options, def->interval_min, def->interval_max, NULL);
+
+  err = bt_le_adv_start(&param, ad, ARRAY_SIZE(ad), sd, ARRAY_SIZE(sd));
   if (err) {
     LOG_ERR("Advertising failed to start (err %d)", err);
+    adv_stage_set(ADV_STAGE_OFF);
     return;
   }
 
-  LOG_INF("Advertising successfully started");
+  adv_stage_set(stage);
+  if (def->duration_s) {
+    k_work_reschedule(&adv_stage_work, K_SECONDS(def->duration_s));
+  }
+  LOG_INF("Advertising %s, %s", def->name, filtered ? "bonded phones only" : "open to pairing");
+}
+
+static void adv_work_handler(struct k_work* work) {
+  ARG_UNUSED(work);
+
+  adv_run(ADV_STAGE_FAST);
+}
+
+/* No phone came during this stage */
+static void adv_stage_work_handler(struct k_work* work) {
+  ARG_UNUSED(work);
+
+  adv_open = true;
+  if (adv_stage < ADV_STAGE_OFF) {
+    adv_run(adv_stage + 1);
+  }
 }
 
 static void advertising_start(void) { k_work_submit(&adv_work); }
@@ -78,6 +191,20 @@ static void connected(struct bt_conn* conn, uint8_t err) {
   bt_addr_le_to_str(bt_conn_get_dst(conn), addr, sizeof(addr));
   LOG_INF("Connected %s", addr);
 
+  link_up = true;
+  k_work_cancel_delayable(&adv_stage_work);
+  adv_open = false;
+  adv_stage_set(ADV_STAGE_OFF);
+  connected_at = k_uptime_get_32();
+  awaiting_noti = true;
+  if (link_lost) {
+    link_lost = false;
+    ble_stats.reconnects++;
+    ble_stats.reconnect_ms = connected_at - link_lost_at;
+    ble_stats.reconnect_max_ms = MAX(ble_stats.reconnect_max_ms, ble_stats.reconnect_ms);
+    LOG_INF("Reconnected %u ms after link loss", ble_stats.reconnect_ms);
+  }
+
   sec_err = bt_conn_set_security(conn, BT_SECURITY_L2);
   if (sec_err) {
     LOG_ERR("Failed to set security (err %d)", sec_err);
@@ -90,12 +217,11 @@ static void disconnected(struct bt_conn* conn, uint8_t reason) {
   bt_addr_le_to_str(bt_conn_get_dst(conn), addr, sizeof(addr));
   LOG_INF("Disconnected from %s, reason 0x%02x %s", addr, reason, bt_hci_err_to_str(reason));
 
-  LOG_INF("Erasing all settings and restarting advertising...");
-
-  clear_all_settings();
-
-  sys_reboot(SYS_REBOOT_COLD);
-  advertising_start();
+  // Keep the bond; advertising restarts in recycled_cb()
+  link_up = false;
+  link_lost = true;
+  link_lost_at = k_uptime_get_32();
+  awaiting_noti = false;
 }
 
 static void security_changed(struct bt_conn* conn, bt_security_t level, enum bt_security_err err) {
@@ -108,6 +234,12 @@ static void security_changed(struct bt_conn* conn, bt_security_t level, enum bt_
   } else {
     LOG_ERR("Security failed: %s level %u err %d %s", addr, level, err, bt_security_err_to_str(err));
   }
+
+  // The phone forgot the bond: drop ours too so it can pair again
+  if (err == BT_SECURITY_ERR_PIN_OR_KEY_MISSING) {
+    LOG_WRN("Removing the stale bond of %s", addr);
+    bt_unpair(BT_ID_DEFAULT, bt_conn_get_dst(conn));
+  }
 }
 
 static void recycled_cb(void) {
@@ -150,6 +282,15 @@ static void pairing_failed(struct bt_conn* conn, enum bt_security_err reason) {
   bt_conn_disconnect(conn, BT_HCI_ERR_REMOTE_USER_TERM_CONN);
 }
 
+static void bond_deleted(uint8_t id, const bt_addr_le_t* peer) {
+  char addr[BT_ADDR_LE_STR_LEN];
+
+  bt_addr_le_to_str(peer, addr, sizeof(addr));
+  LOG_INF("Bond deleted: %s", addr);
+
+  gatt_cache_invalidate(peer);
+}
+
 static struct bt_conn_auth_cb conn_auth_callbacks = {
     .cancel = auth_cancel,
 };
@@ -157,6 +298,7 @@ static struct bt_conn_auth_cb conn_auth_callbacks = {
 static struct bt_conn_auth_info_cb conn_auth_info_callbacks = {
     .pairing_complete = pairing_complete,
     .pairing_failed = pairing_failed,
+    .bond_deleted = bond_deleted,
 };
 
 int ble_init(void) {
@@ -197,7 +339,127 @@ int ble_init(void) {
   }
 
   k_work_init(&adv_work, adv_work_handler);
+  k_work_init_delayable(&adv_stage_work, adv_stage_work_handler);
+  advertising_start();
+
+  return 0;
+}
+
+void ble_adv_wake(void) {
+  if (!link_up && adv_stage != ADV_STAGE_FAST) {
+    advertising_start();
+  }
+}
+
+void ble_set_adv_bonded_only(bool bonded_only) {
+  adv_bonded_only = bonded_only;
+#ifdef CONFIG_SETTINGS
+  int err = settings_save_one("ble/bonded_only", &adv_bonded_only, sizeof(adv_bonded_only));
+  if (err) {
+    LOG_ERR("Failed to save advertising filter (err %d)", err);
+  }
+#endif
+}
+
+#ifdef CONFIG_SETTINGS
+static int ble_settings_set(const char* name, size_t len, settings_read_cb read_cb, void* cb_arg) {
+  if (settings_name_steq(name, "bonded_only", NULL) && len == sizeof(adv_bonded_only)) {
+    return read_cb(cb_arg, &adv_bonded_only, sizeof(adv_bonded_only)) < 0 ? -EIO : 0;
+  }
+  return -ENOENT;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(ble, "ble", NULL, ble_settings_set, NULL, NULL);
+#endif
+
+void ble_session_notified(void) {
+  if (!awaiting_noti) {
+    return;
+  }
+  awaiting_noti = false;
+  ble_stats.first_noti_ms = k_uptime_get_32() - connected_at;
+  ble_stats.first_noti_max_ms = MAX(ble_stats.first_noti_max_ms, ble_stats.first_noti_ms);
+  LOG_INF("First notification %u ms after connecting", ble_stats.first_noti_ms);
+}
+
+#ifdef CONFIG_SHELL
+
+/* Time per stage, estimated advertising events and radio duty cycle since boot */
+static void print_adv(const struct shell* sh) {
+  uint32_t ms[ADV_STAGE_COUNT];
+  uint64_t total_ms = 0;
+  uint64_t radio_us = 0;
+  k_spinlock_key_t key = k_spin_lock(&adv_lock);
+
+  memcpy(ms, adv_ms, sizeof(ms));
+  ms[adv_stage] += k_uptime_get_32() - adv_stage_since;
+  enum adv_stage stage = adv_stage;
+  k_spin_unlock(&adv_lock, key);
+
+  for (int i = 0; i < ADV_STAGE_COUNT; i++) {
+    const struct adv_stage_def* def = &adv_stages[i];
+    uint32_t events = 0;
+
+    if (i != ADV_STAGE_OFF) {
+      uint32_t interval_us = (def->interval_min + def->interval_max) * 625 / 2 + ADV_DELAY_US;
+      events = (uint64_t)ms[i] * 1000 / interval_us;
+      radio_us += (uint64_t)events * ADV_EVENT_US;
+    }
+    total_ms += ms[i];
+    shell_print(sh, "%c %-4s %8u s  ~%u events", i == stage ? '*' : ' ', def->name, ms[i] / 1000, events);
+  }
+  // In thousandths of a percent
+  uint32_t duty = total_ms ? radio_us * 100 / total_ms : 0;
+  shell_print(sh, "advertising radio duty ~%u.%03u%%", duty / 1000, duty % 1000);
+}
+
+static int cmd_ble(const struct shell* sh, size_t argc, char** argv) {
+  int bonds = 0;
+
+  bt_foreach_bond(BT_ID_DEFAULT, count_bond, &bonds);
+  shell_print(sh, "%d bonds, advertising %s%s", bonds,
+              bonds && (!adv_open || adv_bonded_only) ? "to bonded phones" : "open to pairing",
+              adv_bonded_only ? " (bonded only)" : "");
+  shell_print(sh, "reconnects %u: last %u ms, max %u ms after link loss", ble_stats.reconnects,
+              ble_stats.reconnect_ms, ble_stats.reconnect_max_ms);
+  shell_print(sh, "first notification: last %u ms, max %u ms after connecting", ble_stats.first_noti_ms,
+              ble_stats.first_noti_max_ms);
+  print_adv(sh);
+  return 0;
+}
+
+/* Let another phone pair without waiting for the reconnect window to close */
+static int cmd_ble_pair(const struct shell* sh, size_t argc, char** argv) {
+  adv_open = true;
   advertising_start();
+  return 0;
+}
+
+static int cmd_ble_unpair(const struct shell* sh, size_t argc, char** argv) {
+  int err = bt_unpair(BT_ID_DEFAULT, BT_ADDR_LE_ANY);
 
+  if (err) {
+    shell_error(sh, "Failed to remove bonds (err %d)", err);
+    return err;
+  }
+  advertising_start();
+  return 0;
+}
+
+static int cmd_ble_bonded(const struct shell* sh, size_t argc, char** argv) {
+  if (argc > 1) {
+    ble_set_adv_bonded_only(strcmp(argv[1], "on") == 0);
+    advertising_start();
+  }
+  shell_print(sh, "Slow and deep advertising %s", adv_bonded_only ? "bonded phones only" : "open to pairing");
   return 0;
 }
+
+SHELL_STATIC_SUBCMD_SET_CREATE(ble_cmds, SHELL_CMD(pair, NULL, "Advertise to any phone", cmd_ble_pair),
+                               SHELL_CMD(unpair, NULL, "Remove all bonds", cmd_ble_unpair),
+                               SHELL_CMD_ARG(bonded, NULL, "[on|off] Keep advertising to bonded phones only",
+                                             cmd_ble_bonded, 1, 1),
+                               SHELL_SUBCMD_SET_END);
+SHELL_SUBCMD_ADD((diag), ble, &ble_cmds, "Bonds, advertising and reconnection times", cmd_ble, 1, 0);
+
+#endif  // CONFIG_SHELL
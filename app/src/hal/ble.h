@@ -1,6 +1,8 @@
 #ifndef BLE_H
 #define BLE_H
 
+#include <stdbool.h>
+
 /**
  * @brief Initialize the BLE subsystem and start advertising.
  *
@@ -11,4 +13,22 @@
  */
 int ble_init(void);
 
+/**
+ * @brief Back to fast advertising if it has slowed down or stopped; called on
+ * user activity.
+ */
+void ble_adv_wake(void);
+
+/**
+ * @brief Keep advertising to bonded phones only after the fast stage, too;
+ * saved in settings.
+ */
+void ble_set_adv_bonded_only(bool bonded_only);
+
+/**
+ * @brief Note that a notification arrived. The first one after each
+ * connection is timed; reported by "diag ble".
+ */
+void ble_session_notified(void);
+
 #endif /* BLE_H */
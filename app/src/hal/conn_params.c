@@ -0,0 +1,194 @@
+#include "conn_params.h"
+
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/hci.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+LOG_MODULE_REGISTER(conn_params);
+
+/*
+ * Profiles within Apple's accessory guidelines: interval in 1.25 ms units,
+ * min + 15 ms <= max, max * (latency + 1) <= 2 s and three times that under
+ * the supervision timeout (10 ms units).
+ */
+#define FAST_INTERVAL_MIN 12  // 15 ms
+#define FAST_INTERVAL_MAX 24  // 30 ms
+#define FAST_LATENCY 0
+#define FAST_TIMEOUT 400       // 4 s
+#define IDLE_INTERVAL_MIN 312  // 390 ms
+#define IDLE_INTERVAL_MAX 336  // 420 ms
+#define IDLE_LATENCY 3         // the watch may sleep through 3 connection events
+#define IDLE_TIMEOUT 600       // 6 s
+
+#define IDLE_DELAY_MS 2000  // after the last demand drops, so bursts do not flap the link
+
+// Demands that end with the link; the others belong to their owners across reconnects
+#define LINK_DEMANDS (BIT(CONN_DEMAND_DISCOVERY) | BIT(CONN_DEMAND_ANCS) | BIT(CONN_DEMAND_CTS))
+
+enum conn_profile {
+  CONN_PROFILE_FAST,
+  CONN_PROFILE_IDLE,
+  CONN_PROFILE_OTHER,  // whatever the phone chose
+  CONN_PROFILE_COUNT,
+};
+
+struct conn_params_stats {
+  uint32_t ms[CONN_PROFILE_COUNT];  // connected time per profile
+  uint32_t requests;
+  uint32_t failed;
+  uint32_t updates;  // parameters changed, by us or the phone
+};
+
+static const char* const profile_names[CONN_PROFILE_COUNT] = {"fast", "idle", "other"};
+static const struct bt_le_conn_param fast_param =
+    BT_LE_CONN_PARAM_INIT(FAST_INTERVAL_MIN, FAST_INTERVAL_MAX, FAST_LATENCY, FAST_TIMEOUT);
+static const struct bt_le_conn_param idle_param =
+    BT_LE_CONN_PARAM_INIT(IDLE_INTERVAL_MIN, IDLE_INTERVAL_MAX, IDLE_LATENCY, IDLE_TIMEOUT);
+
+static struct bt_conn* conn;
+static atomic_t demands;
+static enum conn_profile requested = CONN_PROFILE_OTHER;
+static enum conn_profile current;
+static uint32_t current_since;
+static uint16_t cur_interval;
+static uint16_t cur_latency;
+static uint16_t cur_timeout;
+static struct conn_params_stats stats;
+
+static void param_work_fn(struct k_work* work);
+static K_WORK_DELAYABLE_DEFINE(param_work, param_work_fn);
+
+static enum conn_profile profile_of(uint16_t interval) {
+  if (interval <= FAST_INTERVAL_MAX) {
+    return CONN_PROFILE_FAST;
+  }
+  return interval >= IDLE_INTERVAL_MIN ? CONN_PROFILE_IDLE : CONN_PROFILE_OTHER;
+}
+
+/* Charge the time since the last change to the profile in use */
+static void account(void) {
+  uint32_t now = k_uptime_get_32();
+
+  stats.ms[current] += now - current_since;
+  current_since = now;
+}
+
+static void params_set(uint16_t interval, uint16_t latency, uint16_t timeout) {
+  account();
+  current = profile_of(interval);
+  cur_interval = interval;
+  cur_latency = latency;
+  cur_timeout = timeout;
+}
+
+static void param_work_fn(struct k_work* work) {
+  enum conn_profile want = atomic_get(&demands) ? CONN_PROFILE_FAST : CONN_PROFILE_IDLE;
+  int err;
+
+  if (conn == NULL || want == requested) {
+    return;
+  }
+  stats.requests++;
+  err = bt_conn_le_param_update(conn, want == CONN_PROFILE_FAST ? &fast_param : &idle_param);
+  if (err) {
+    stats.failed++;
+    LOG_WRN("Failed to request %s parameters (err %d)", profile_names[want], err);
+    return;
+  }
+  requested = want;
+  LOG_DBG("Requested %s parameters", profile_names[want]);
+}
+
+void conn_params_demand(enum conn_demand demand, bool on) {
+  if (on) {
+    if (!atomic_test_and_set_bit(&demands, demand)) {
+      k_work_reschedule(&param_work, K_NO_WAIT);
+    }
+  } else if (atomic_test_and_clear_bit(&demands, demand) && atomic_get(&demands) == 0) {
+    k_work_reschedule(&param_work, K_MSEC(IDLE_DELAY_MS));
+  }
+}
+
+static void connected(struct bt_conn* c, uint8_t err) {
+  struct bt_conn_info info;
+
+  if (err || conn != NULL) {
+    return;
+  }
+  conn = bt_conn_ref(c);
+  requested = CONN_PROFILE_OTHER;
+  current_since = k_uptime_get_32();
+  if (bt_conn_get_info(c, &info) == 0) {
+    current = profile_of(info.le.interval);
+    cur_interval = info.le.interval;
+    cur_latency = info.le.latency;
+    cur_timeout = info.le.timeout;
+  }
+  // Fast right away if the screen is still awake, else idle unless a client raises a demand
+  k_work_reschedule(&param_work, atomic_get(&demands) ? K_NO_WAIT : K_MSEC(IDLE_DELAY_MS));
+}
+
+static void disconnected(struct bt_conn* c, uint8_t reason) {
+  if (c != conn) {
+    return;
+  }
+  account();
+  atomic_and(&demands, ~LINK_DEMANDS);
+  k_work_cancel_delayable(&param_work);
+  bt_conn_unref(conn);
+  conn = NULL;
+}
+
+static void le_param_updated(struct bt_conn* c, uint16_t interval, uint16_t latency, uint16_t timeout) {
+  if (c != conn) {
+    return;
+  }
+  params_set(interval, latency, timeout);
+  stats.updates++;
+  LOG_INF("Connection interval %u.%02u ms, latency %u, timeout %u ms (%s)", interval * 5 / 4, interval * 125 % 100,
+          latency, timeout * 10, profile_names[current]);
+
+  // The phone chose otherwise: ask again when the demands next change
+  if (current != requested) {
+    requested = CONN_PROFILE_OTHER;
+  }
+}
+
+BT_CONN_CB_DEFINE(conn_params_callbacks) = {
+    .connected = connected,
+    .disconnected = disconnected,
+    .le_param_updated = le_param_updated,
+};
+
+#ifdef CONFIG_SHELL
+
+static int cmd_conn(const struct shell* sh, size_t argc, char** argv) {
+  uint32_t total = 0;
+
+  if (conn != NULL) {
+    account();
+    shell_print(sh, "interval %u.%02u ms, latency %u, timeout %u ms (%s), demands 0x%02lx", cur_interval * 5 / 4,
+                cur_interval * 125 % 100, cur_latency, cur_timeout * 10, profile_names[current],
+                (unsigned long)atomic_get(&demands));
+  } else {
+    shell_print(sh, "not connected");
+  }
+  for (int i = 0; i < CONN_PROFILE_COUNT; i++) {
+    total += stats.ms[i];
+  }
+  for (int i = 0; i < CONN_PROFILE_COUNT; i++) {
+    shell_print(sh, "%-5s %8u s  %3u%%", profile_names[i], stats.ms[i] / 1000,
+                total ? (uint32_t)((uint64_t)stats.ms[i] * 100 / total) : 0);
+  }
+  shell_print(sh, "requests %u  failed %u  updates %u", stats.requests, stats.failed, stats.updates);
+  return 0;
+}
+
+SHELL_SUBCMD_ADD((diag), conn, NULL, "Connection parameters and time per profile", cmd_conn, 1, 0);
+
+#endif  // CONFIG_SHELL
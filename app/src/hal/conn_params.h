@@ -0,0 +1,25 @@
+#ifndef CONN_PARAMS_H
+#define CONN_PARAMS_H
+
+#include <stdbool.h>
+
+/*
+ * Connection parameters follow activity: while any demand is raised the
+ * watch asks the phone for a short interval, and a while after the last one
+ * drops for a long interval with peripheral latency.
+ */
+enum conn_demand {
+  CONN_DEMAND_DISCOVERY,  // GATT discovery of ANCS after securing the link
+  CONN_DEMAND_ANCS,       // attribute requests waiting or in flight
+  CONN_DEMAND_CTS,        // time service discovery and first read
+  CONN_DEMAND_USER,       // screen awake, see modes.c
+  CONN_DEMAND_COUNT,
+};
+
+/**
+ * @brief Raise or drop @p demand. Any thread; the link-scoped demands
+ * (discovery, ANCS, CTS) are cleared on disconnect, CONN_DEMAND_USER is kept.
+ */
+void conn_params_demand(enum conn_demand demand, bool on);
+
+#endif  // CONN_PARAMS_H
@@ -10,7 +10,9 @@
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 
+#include "conn_params.h"
 #include "event.h"
+#include "gatt_cache.h"
 
 LOG_MODULE_REGISTER(app_cts_client);
 
@@ -49,7 +51,7 @@ static void apply_current_time(const struct bt_cts_current_time* current_time) {
     return;
   }
 
-  struct rtc_time* time_ptr = k_malloc(sizeof(struct rtc_time));
+  struct rtc_time* time_ptr = event_payload_alloc(APP_EVENT_BLE_CTS);
   if (!time_ptr) {
     LOG_ERR("Failed to allocate memory for CTS time");
     return;
@@ -61,7 +63,10 @@ static void apply_current_time(const struct bt_cts_current_time* current_time) {
       .ptr = time_ptr,
       .len = sizeof(struct rtc_time),
   };
-  event_post(&event);
+  if (event_post(&event) < 0) {
+    event_payload_free(APP_EVENT_BLE_CTS, time_ptr);
+    return;
+  }
 
   LOG_INF("CTS event posted");
 }
@@ -74,6 +79,7 @@ static void notify_current_time_cb(struct bt_cts_client* cts, struct bt_cts_curr
 static void read_current_time_cb(struct bt_cts_client* cts, struct bt_cts_current_time* current_time, int err) {
   ARG_UNUSED(cts);
 
+  conn_params_demand(CONN_DEMAND_CTS, false);
   if (err) {
     LOG_ERR("CTS read failed: %d", err);
     return;
@@ -93,12 +99,30 @@ static void enable_notifications(void) {
   err = bt_cts_subscribe_current_time(&cts_c, notify_current_time_cb);
   if (err) {
     LOG_ERR("CTS notify subscribe failed: %d", err);
+    conn_params_demand(CONN_DEMAND_CTS, false);
     return;
   }
 
   err = bt_cts_read_current_time(&cts_c, read_current_time_cb);
   if (err) {
     LOG_ERR("CTS initial read failed: %d", err);
+    conn_params_demand(CONN_DEMAND_CTS, false);
+  }
+}
+
+/* Handles known, from discovery or the cache: subscribe once the link is encrypted */
+static void cts_ready(void) {
+  int err;
+
+  has_cts = true;
+
+  if (bt_conn_get_security(cts_c.conn) < BT_SECURITY_L2) {
+    err = bt_conn_set_security(cts_c.conn, BT_SECURITY_L2);
+    if (err) {
+      LOG_ERR("Set security failed: %d", err);
+    }
+  } else {
+    enable_notifications();
   }
 }
 
@@ -112,17 +136,12 @@ static void discover_completed_cb(struct bt_gatt_dm* dm, void* ctx) {
   err = bt_cts_handles_assign(dm, &cts_c);
   if (err) {
     LOG_ERR("CTS handle assign failed: %d", err);
+    conn_params_demand(CONN_DEMAND_CTS, false);
   } else {
-    has_cts = true;
-
-    if (bt_conn_get_security(cts_c.conn) < BT_SECURITY_L2) {
-      err = bt_conn_set_security(cts_c.conn, BT_SECURITY_L2);
-      if (err) {
-        LOG_ERR("Set security failed: %d", err);
-      }
-    } else {
-      enable_notifications();
-    }
+    uint16_t handles[GATT_CACHE_HANDLES] = {cts_c.handle_cts, cts_c.handle_cts_ccc};
+
+    gatt_cache_set(bt_conn_get_dst(cts_c.conn), GATT_CACHE_CTS, handles);
+    cts_ready();
   }
 
   err = bt_gatt_dm_data_release(dm);
@@ -136,6 +155,7 @@ static void discover_service_not_found_cb(struct bt_conn* conn, void* ctx) {
   ARG_UNUSED(ctx);
 
   LOG_WRN("CTS not found");
+  conn_params_demand(CONN_DEMAND_CTS, false);
 }
 
 static void discover_error_found_cb(struct bt_conn* conn, int err, void* ctx) {
@@ -143,6 +163,7 @@ static void discover_error_found_cb(struct bt_conn* conn, int err, void* ctx) {
   ARG_UNUSED(ctx);
 
   LOG_ERR("CTS discovery failed: %d", err);
+  conn_params_demand(CONN_DEMAND_CTS, false);
 }
 
 static const struct bt_gatt_dm_cb discover_cb = {
@@ -151,16 +172,37 @@ static const struct bt_gatt_dm_cb discover_cb = {
     .error_found = discover_error_found_cb,
 };
 
+/* Reuse the handles found on an earlier connection to this phone */
+static bool restore_handles(struct bt_conn* conn) {
+  uint16_t handles[GATT_CACHE_HANDLES];
+
+  if (gatt_cache_get(bt_conn_get_dst(conn), GATT_CACHE_CTS, handles)) {
+    return false;
+  }
+  cts_c.conn = conn;
+  cts_c.handle_cts = handles[0];
+  cts_c.handle_cts_ccc = handles[1];
+  LOG_INF("CTS handles from cache");
+  return true;
+}
+
 static void connected(struct bt_conn* conn, uint8_t err) {
   if (err) {
     return;
   }
 
   has_cts = false;
+  conn_params_demand(CONN_DEMAND_CTS, true);
+
+  if (restore_handles(conn)) {
+    cts_ready();
+    return;
+  }
 
   err = bt_gatt_dm_start(conn, BT_UUID_CTS, &discover_cb, NULL);
   if (err) {
     LOG_ERR("CTS discovery start failed: %d", err);
+    conn_params_demand(CONN_DEMAND_CTS, false);
   }
 }
 
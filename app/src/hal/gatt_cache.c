@@ -0,0 +1,121 @@
+#include "gatt_cache.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+
+LOG_MODULE_REGISTER(gatt_cache);
+
+#define GATT_KEY_LEN sizeof("gatt/0123456789ab0/gattp")
+
+struct gatt_cache_stats {
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t saves;
+  uint32_t invalidations;
+};
+
+struct gatt_cache_load {
+  uint16_t* handles;
+  bool found;
+};
+
+static const char* const service_names[GATT_CACHE_COUNT] = {"gattp", "ancs", "cts"};
+static const uint8_t service_handles[GATT_CACHE_COUNT] = {2, 5, 2};
+
+static struct gatt_cache_stats stats;
+
+#ifdef CONFIG_SETTINGS
+/* Identity address and type, as Zephyr's own bond keys spell them */
+static void gatt_key(char* key, const bt_addr_le_t* peer, enum gatt_cache_service service) {
+  const uint8_t* a = peer->a.val;
+
+  snprintf(key, GATT_KEY_LEN, "gatt/%02x%02x%02x%02x%02x%02x%u/%s", a[5], a[4], a[3], a[2], a[1], a[0], peer->type,
+           service_names[service]);
+}
+
+static int gatt_load_cb(const char* key, size_t len, settings_read_cb read_cb, void* cb_arg, void* param) {
+  struct gatt_cache_load* load = param;
+
+  // Only the record itself, no deeper keys
+  if (key != NULL && key[0] != '\0') {
+    return 0;
+  }
+  if (len != GATT_CACHE_HANDLES * sizeof(uint16_t)) {
+    return -EINVAL;
+  }
+  load->found = read_cb(cb_arg, load->handles, len) == len;
+  return 0;
+}
+#endif
+
+int gatt_cache_get(const bt_addr_le_t* peer, enum gatt_cache_service service, uint16_t handles[GATT_CACHE_HANDLES]) {
+  struct gatt_cache_load load = {.handles = handles};
+
+#ifdef CONFIG_SETTINGS
+  char key[GATT_KEY_LEN];
+
+  gatt_key(key, peer, service);
+  settings_load_subtree_direct(key, gatt_load_cb, &load);
+#endif
+  // A zero handle would make the client write to nothing: rediscover instead
+  for (int i = 0; load.found && i < service_handles[service]; i++) {
+    load.found = handles[i] != 0;
+  }
+  if (!load.found) {
+    stats.misses++;
+    return -ENOENT;
+  }
+  stats.hits++;
+  LOG_DBG("Cached %s handles", service_names[service]);
+  return 0;
+}
+
+void gatt_cache_set(const bt_addr_le_t* peer, enum gatt_cache_service service,
+                    const uint16_t handles[GATT_CACHE_HANDLES]) {
+#ifdef CONFIG_SETTINGS
+  char key[GATT_KEY_LEN];
+
+  // Before the phone shares its identity the address is a private one that will not come back
+  if (bt_addr_le_is_rpa(peer)) {
+    return;
+  }
+  gatt_key(key, peer, service);
+  int err = settings_save_one(key, handles, GATT_CACHE_HANDLES * sizeof(uint16_t));
+  if (err) {
+    LOG_ERR("Failed to save %s handles (err %d)", service_names[service], err);
+    return;
+  }
+  stats.saves++;
+#endif
+}
+
+void gatt_cache_invalidate(const bt_addr_le_t* peer) {
+#ifdef CONFIG_SETTINGS
+  char key[GATT_KEY_LEN];
+
+  for (int i = 0; i < GATT_CACHE_COUNT; i++) {
+    gatt_key(key, peer, i);
+    settings_delete(key);
+  }
+  stats.invalidations++;
+  LOG_INF("Cached handles dropped");
+#endif
+}
+
+#ifdef CONFIG_SHELL
+
+static int cmd_gatt(const struct shell* sh, size_t argc, char** argv) {
+  shell_print(sh, "cached services: hits %u  misses %u  saved %u  invalidated %u", stats.hits, stats.misses,
+              stats.saves, stats.invalidations);
+  return 0;
+}
+
+SHELL_SUBCMD_ADD((diag), gatt, NULL, "GATT handle cache", cmd_gatt, 1, 0);
+
+#endif  // CONFIG_SHELL
@@ -0,0 +1,41 @@
+#ifndef GATT_CACHE_H
+#define GATT_CACHE_H
+
+#include <stdint.h>
+#include <zephyr/bluetooth/addr.h>
+
+/*
+ * Attribute handles of the phone's services, saved per bonded peer so a
+ * reconnect can subscribe straight away instead of walking the phone's GATT
+ * database again. Each service is one "gatt/<addr>/<service>" settings record.
+ * The handles stay valid until the phone indicates Service Changed or the
+ * bond is removed.
+ */
+enum gatt_cache_service {
+  GATT_CACHE_GATTP,  // sc, sc_ccc
+  GATT_CACHE_ANCS,   // cp, ns, ns_ccc, ds, ds_ccc
+  GATT_CACHE_CTS,    // cts, cts_ccc
+  GATT_CACHE_COUNT,
+};
+
+#define GATT_CACHE_HANDLES 5  // the most any cached service needs
+
+/**
+ * @brief Copy the saved handles of @p service on @p peer into @p handles.
+ * @return 0 on a hit, -ENOENT when the service must be discovered.
+ */
+int gatt_cache_get(const bt_addr_le_t* peer, enum gatt_cache_service service, uint16_t handles[GATT_CACHE_HANDLES]);
+
+/**
+ * @brief Save the handles of @p service found by discovery on @p peer.
+ */
+void gatt_cache_set(const bt_addr_le_t* peer, enum gatt_cache_service service,
+                    const uint16_t handles[GATT_CACHE_HANDLES]);
+
+/**
+ * @brief Forget every service of @p peer, after Service Changed or when its
+ * bond is deleted.
+ */
+void gatt_cache_invalidate(const bt_addr_le_t* peer);
+
+#endif  // GATT_CACHE_H
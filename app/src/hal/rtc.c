@@ -10,6 +10,11 @@ LOG_MODULE_REGISTER(rtc_module);
 
 static const struct device* rtc_dev = DEVICE_DT_GET(DT_NODELABEL(rv8263));
 
+static struct k_timer second_timer;
+static bool minute_alarm_enabled;
+static bool second_tick_enabled;
+static uint8_t second_of_minute;
+
 static int rtc_schedule_next_minute_alarm(void) {
   struct rtc_time now;
   int ret = rtc_get_time(rtc_dev, &now);
@@ -72,6 +77,26 @@ static void rtc_minute_alarm_cb(const struct device* dev, uint16_t id, void* use
   };
   event_post(&event);
   rtc_schedule_next_minute_alarm();
+
+  if (second_tick_enabled) {
+    // Second 0 is covered by the alarm itself, restart the ticker in phase with it
+    second_of_minute = 0;
+    k_timer_start(&second_timer, K_SECONDS(1), K_SECONDS(1));
+  }
+}
+
+static void rtc_second_timer_cb(struct k_timer* timer) {
+  (void)timer;
+
+  if (second_of_minute < 59) {
+    second_of_minute++;
+  }
+  app_event_t event = {
+      .type = APP_EVENT_RTC_SECOND,
+      .value = second_of_minute,
+      .len = 0,
+  };
+  event_post(&event);
 }
 
 int rtc_init(void) {
@@ -80,6 +105,8 @@ int rtc_init(void) {
     return -ENODEV;
   }
 
+  k_timer_init(&second_timer, rtc_second_timer_cb, NULL);
+
   LOG_INF("RTC initialized");
   return 0;
 }
@@ -112,6 +139,21 @@ int rtc_time_set(const struct rtc_time* time) {
   }
 
   LOG_INF("RTC time set");
+
+  // The pending alarm matches the old hour and minute, the ticker counts the old seconds
+  if (minute_alarm_enabled) {
+    rtc_schedule_next_minute_alarm();
+  }
+  if (second_tick_enabled) {
+    second_of_minute = time->tm_sec;
+    k_timer_start(&second_timer, K_SECONDS(1), K_SECONDS(1));
+  }
+  // Everything showing the time is stale, redraw as on a minute change
+  app_event_t event = {
+      .type = APP_EVENT_RTC_ALARM,
+      .len = 0,
+  };
+  event_post(&event);
   return 0;
 }
 
@@ -125,10 +167,31 @@ int rtc_minute_alarm_enable(void) {
     LOG_ERR("Failed to set alarm callback: %d", ret);
     return ret;
   }
+  minute_alarm_enabled = true;
 
   return rtc_schedule_next_minute_alarm();
 }
 
+int rtc_second_tick_enable(bool enable) {
+  if (enable == second_tick_enabled) {
+    return 0;
+  }
+
+  if (enable) {
+    struct rtc_time now;
+    int ret = rtc_time_get(&now);
+    if (ret < 0) {
+      return ret;
+    }
+    second_of_minute = now.tm_sec;
+    k_timer_start(&second_timer, K_SECONDS(1), K_SECONDS(1));
+  } else {
+    k_timer_stop(&second_timer);
+  }
+  second_tick_enabled = enable;
+  return 0;
+}
+
 void rtc_test(void) {
   if (rtc_init() < 0) {
     return;
@@ -1,12 +1,26 @@
 #ifndef RTC_H
 #define RTC_H
 
+#include <stdbool.h>
 #include <zephyr/drivers/rtc.h>
 
 int rtc_init(void);
 int rtc_time_get(struct rtc_time* time);
+
+/**
+ * @brief Set the RTC time.
+ * The minute alarm and the seconds ticker are re-aligned to the new time and
+ * an APP_EVENT_RTC_ALARM is posted so the time shown follows at once.
+ */
 int rtc_time_set(const struct rtc_time* time);
 int rtc_minute_alarm_enable(void);
+
+/**
+ * @brief Start or stop the 1 Hz APP_EVENT_RTC_SECOND ticker.
+ * Ticks come from a kernel timer on the low-power system clock and carry the
+ * second of the minute in the event value; the minute alarm re-aligns them.
+ */
+int rtc_second_tick_enable(bool enable);
 void rtc_test(void);
 
 #endif /* RTC_H */
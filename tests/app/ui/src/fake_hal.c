@@ -0,0 +1,52 @@
+/* HAL stand-ins for the UI tests: events are posted by the tests themselves */
+#include "fake_hal.h"
+
+#include <errno.h>
+
+#include "ancs_client.h"
+#include "ble.h"
+#include "conn_params.h"
+#include "rtc.h"
+
+static struct rtc_time now;
+static bool has_time;
+static bool second_tick;
+
+void fake_rtc_set(const struct rtc_time* time) {
+  now = *time;
+  has_time = true;
+}
+
+bool fake_rtc_second_tick_enabled(void) { return second_tick; }
+
+int rtc_init(void) { return 0; }
+
+int rtc_time_get(struct rtc_time* time) {
+  if (!has_time) {
+    return -ENODATA;
+  }
+  *time = now;
+  return 0;
+}
+
+int rtc_time_set(const struct rtc_time* time) {
+  fake_rtc_set(time);
+  return 0;
+}
+
+int rtc_minute_alarm_enable(void) { return 0; }
+
+int rtc_second_tick_enable(bool enable) {
+  second_tick = enable;
+  return 0;
+}
+
+void rtc_test(void) {}
+
+/* No phone: opened notifications keep an empty message */
+int ancs_client_request_message(uint32_t uid) { return -ENOTCONN; }
+
+/* No radio: nothing to advertise or tune */
+void ble_adv_wake(void) {}
+
+void conn_params_demand(enum conn_demand demand, bool on) {}
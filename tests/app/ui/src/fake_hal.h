@@ -0,0 +1,17 @@
+#ifndef FAKE_HAL_H
+#define FAKE_HAL_H
+
+#include <stdbool.h>
+#include <zephyr/drivers/rtc.h>
+
+/**
+ * @brief Set the time the fake RTC reports from now on.
+ */
+void fake_rtc_set(const struct rtc_time* time);
+
+/**
+ * @brief Whether the UI asked for the 1 Hz seconds ticker.
+ */
+bool fake_rtc_second_tick_enabled(void);
+
+#endif  // FAKE_HAL_H
@@ -0,0 +1,111 @@
+/*
+ * Memory-in-pixel panel on the emulated SPI bus of the UI tests. The real
+ * driver/LPM013M126A.c talks to it; it decodes the command stream into the
+ * frame the panel would show and counts the lines it receives.
+ */
+#include <string.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/emul_stub_device.h>
+#include <zephyr/drivers/spi_emul.h>
+#include <zephyr/sys/util.h>
+
+#include "fake_lcd.h"
+
+#define DT_DRV_COMPAT vnd_spi_device
+
+#define STRIDE (LCD_DISP_WIDTH / 2)
+#define CMD_POLARITY 0x40
+
+enum panel_rx_state {
+  RX_CMD,
+  RX_ADDR,
+  RX_DATA,
+  RX_DUMMY,
+};
+
+/* Where the decoder is in the current command */
+static struct {
+  enum panel_rx_state state;
+  uint16_t row;
+  uint16_t pos;
+  uint8_t dummy;  // trailing bytes still to come
+} rx;
+
+static uint8_t panel[LCD_FRAME_BYTES];
+static uint32_t row_sends[LCD_DISP_HEIGHT];
+
+static void panel_rx(uint8_t b) {
+  switch (rx.state) {
+    case RX_CMD:
+      if ((b & ~CMD_POLARITY) == LCD_COLOR_CMD_UPDATE) {
+        rx.state = RX_ADDR;
+        break;
+      }
+      if ((b & ~CMD_POLARITY) == LCD_COLOR_CMD_ALL_CLEAR) {
+        memset(panel, (LCD_COLOR_WHITE << 4) | LCD_COLOR_WHITE, sizeof(panel));
+      }
+      // Mode commands are followed by one dummy byte
+      rx.dummy = 1;
+      rx.state = RX_DUMMY;
+      break;
+    case RX_ADDR:
+      // Lines are numbered from 1
+      rx.row = b - 1;
+      rx.pos = 0;
+      rx.state = RX_DATA;
+      break;
+    case RX_DATA:
+      if (rx.row < LCD_DISP_HEIGHT) {
+        panel[STRIDE * rx.row + rx.pos] = b;
+      }
+      if (++rx.pos == STRIDE) {
+        if (rx.row < LCD_DISP_HEIGHT) {
+          row_sends[rx.row]++;
+        }
+        rx.dummy = 2;
+        rx.state = RX_DUMMY;
+      }
+      break;
+    case RX_DUMMY:
+      if (--rx.dummy == 0) {
+        rx.state = RX_CMD;
+      }
+      break;
+  }
+}
+
+static int fake_lcd_io(const struct emul* target, const struct spi_config* config, const struct spi_buf_set* tx_bufs,
+                       const struct spi_buf_set* rx_bufs) {
+  ARG_UNUSED(target);
+  ARG_UNUSED(config);
+  ARG_UNUSED(rx_bufs);
+
+  for (size_t i = 0; tx_bufs && i < tx_bufs->count; i++) {
+    const uint8_t* buf = tx_bufs->buffers[i].buf;
+
+    for (size_t j = 0; buf && j < tx_bufs->buffers[i].len; j++) {
+      panel_rx(buf[j]);
+    }
+  }
+  return 0;
+}
+
+static struct spi_emul_api fake_lcd_api = {
+    .io = fake_lcd_io,
+};
+
+static int fake_lcd_init(const struct emul* target, const struct device* parent) {
+  ARG_UNUSED(target);
+  ARG_UNUSED(parent);
+  return 0;
+}
+
+EMUL_DT_DEFINE(DT_DRV_INST(0), fake_lcd_init, NULL, NULL, &fake_lcd_api, NULL);
+
+/* The emulated bus links its devices; the panel has no driver model of its own */
+EMUL_STUB_DEVICE(0)
+
+const uint8_t* fake_lcd_frame(void) { return panel; }
+
+uint32_t fake_lcd_row_sends(int16_t row) { return row < 0 || row >= LCD_DISP_HEIGHT ? 0 : row_sends[row]; }
@@ -0,0 +1,21 @@
+#ifndef FAKE_LCD_H
+#define FAKE_LCD_H
+
+#include <stdint.h>
+
+#include "driver/LPM013M126A.h"
+
+/* Modelled time to send one panel line: 1 MHz SPI plus 6 us CS setup and hold */
+#define FAKE_LCD_LINE_US (LCD_LINE_XFER_BYTES * 8 + 12)
+
+/**
+ * @brief Panel-format frame the panel shows, as decoded from the SPI traffic.
+ */
+const uint8_t* fake_lcd_frame(void);
+
+/**
+ * @brief How many refreshes sent panel line @p row since boot.
+ */
+uint32_t fake_lcd_row_sends(int16_t row);
+
+#endif  // FAKE_LCD_H
@@ -0,0 +1,34 @@
+#ifndef GOLDEN_H
+#define GOLDEN_H
+
+#include <stdint.h>
+
+/* Scenes of the UI suite, in the order the tests drive them */
+enum ui_scene {
+  SCENE_BOOT,
+  SCENE_MINUTE_TICK,
+  SCENE_BATTERY,
+  SCENE_ANCS_BURST,
+  SCENE_TOAST_HIDDEN,
+  SCENE_NOTI_LIST,
+  SCENE_BACK_TO_FACE,
+  SCENE_COUNT,
+};
+
+/*
+ * CRC-32 (IEEE) of the panel frame after each scene. 0 means not recorded
+ * yet, which fails the scene. Record with:
+ *   west build -b native_sim tests/app/ui -t run -- -DCONFIG_UI_TEST_RECORD=y
+ * then drop build_only from testcase.yaml.
+ */
+static const uint32_t golden_crc[SCENE_COUNT] = {
+    [SCENE_BOOT] = 0,
+    [SCENE_MINUTE_TICK] = 0,
+    [SCENE_BATTERY] = 0,
+    [SCENE_ANCS_BURST] = 0,
+    [SCENE_TOAST_HIDDEN] = 0,
+    [SCENE_NOTI_LIST] = 0,
+    [SCENE_BACK_TO_FACE] = 0,
+};
+
+#endif  // GOLDEN_H
@@ -0,0 +1,258 @@
+/*
+ * @file UI render regression suite
+ *
+ * Boots the app's screens and the real panel driver on an emulated SPI
+ * panel, and drives the canonical events through the real event queue and
+ * LVGL. After each scene the frame the panel received is compared with a
+ * golden CRC and the display path is held to a budget: panel rows and SPI
+ * bytes sent, modelled SPI time, and pixels flushed by LVGL. native_sim
+ * time does not advance while code runs, so flushed pixels stand in for
+ * render time.
+ *
+ * Tests share one app instance and run in name order, hence the numbering.
+ */
+#include <lvgl.h>
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/ztest.h>
+
+#include "app.h"
+#include "fake_hal.h"
+#include "fake_lcd.h"
+#include "golden.h"
+#include "hal/ancs_client.h"
+
+/* Panel row bands of the classic face and the toast */
+#define STATUS_Y1 7
+#define STATUS_Y2 30
+#define TIME_Y1 37
+#define TIME_Y2 100
+#define TOAST_Y1 124
+#define TOAST_Y2 175
+#define BAND(y1, y2) ((y2) - (y1) + 1)
+
+#define BURST_SIZE 5
+#define BURST_GAP_MS 20
+
+/* lv_timer_handler() and lv_refr_now() in ui_settle() may each refresh the panel */
+#define SETTLE_REFRESHES 2
+
+struct ui_cost {
+  uint32_t refreshes;
+  uint32_t rows;
+  uint32_t bytes;
+  uint32_t spi_us;
+  uint32_t pixels;
+};
+
+struct ui_budget {
+  uint32_t refreshes;
+  uint32_t rows;
+  uint32_t pixels;
+};
+
+/*
+ * Budgets are panel refreshes, rows sent and pixels flushed; bytes and time
+ * follow from rows
+ */
+static const struct ui_budget budgets[SCENE_COUNT] = {
+    // Panel clear plus the first render
+    [SCENE_BOOT] = {1 + SETTLE_REFRESHES, 2 * LCD_DISP_HEIGHT, LCD_DISP_WIDTH * LCD_DISP_HEIGHT},
+    [SCENE_MINUTE_TICK] = {SETTLE_REFRESHES, BAND(TIME_Y1, TIME_Y2), LCD_DISP_WIDTH * BAND(TIME_Y1, TIME_Y2)},
+    [SCENE_BATTERY] = {SETTLE_REFRESHES, BAND(STATUS_Y1, STATUS_Y2), LCD_DISP_WIDTH * BAND(STATUS_Y1, STATUS_Y2)},
+    // Every arrival redraws the counter, the burst draws the toast once
+    [SCENE_ANCS_BURST] = {(BURST_SIZE + 1) * SETTLE_REFRESHES,
+                          BURST_SIZE * BAND(STATUS_Y1, STATUS_Y2) + BAND(TOAST_Y1, TOAST_Y2),
+                          LCD_DISP_WIDTH * (BURST_SIZE * BAND(STATUS_Y1, STATUS_Y2) + BAND(TOAST_Y1, TOAST_Y2))},
+    [SCENE_TOAST_HIDDEN] = {SETTLE_REFRESHES, BAND(TOAST_Y1, TOAST_Y2), LCD_DISP_WIDTH * BAND(TOAST_Y1, TOAST_Y2)},
+    // A snapshot restore on the switch, then the render
+    [SCENE_NOTI_LIST] = {1 + SETTLE_REFRESHES, LCD_DISP_HEIGHT, LCD_DISP_WIDTH * LCD_DISP_HEIGHT},
+    // The snapshot brings the face back; LVGL's full redraw must not add rows
+    [SCENE_BACK_TO_FACE] = {1 + SETTLE_REFRESHES, LCD_DISP_HEIGHT, LCD_DISP_WIDTH * LCD_DISP_HEIGHT},
+};
+
+static const char* const scene_names[SCENE_COUNT] = {
+    "boot", "minute_tick", "battery", "ancs_burst", "toast_hidden", "noti_list", "back_to_face",
+};
+
+static struct ui_cost mark;
+static uint32_t pixels;
+static struct rtc_time now = {
+    .tm_year = 2025 - 1900,
+    .tm_mon = 2,
+    .tm_mday = 14,
+    .tm_wday = 5,
+    .tm_hour = 9,
+    .tm_min = 41,
+};
+
+static void ui_cost_now(struct ui_cost* cost) {
+  struct cmlcd_stats lcd;
+
+  cmlcd_stats_get(&lcd);
+  cost->refreshes = lcd.refreshes;
+  cost->rows = lcd.rows;
+  cost->bytes = lcd.bytes;
+  cost->spi_us = lcd.rows * FAKE_LCD_LINE_US;
+  cost->pixels = pixels;
+}
+
+/* Render work: every area LVGL hands to the flush callback */
+static void ui_count_flushed(lv_event_t* e) { pixels += lv_area_get_size(lv_event_get_param(e)); }
+
+/* Dispatch everything queued, then render what it invalidated */
+static void ui_settle(void) {
+  app_task_step(K_NO_WAIT);
+  lv_refr_now(NULL);
+}
+
+static void ui_post(app_event_type_t type, uint32_t value) {
+  app_event_t event = {
+      .type = type,
+      .value = value,
+  };
+  zassert_ok(event_post(&event));
+}
+
+static void ui_post_notification(const char* app, const char* title) {
+  static uint32_t uid;
+  ancs_noti_info_t* info = event_payload_alloc(APP_EVENT_BLE_ANCS);
+
+  zassert_not_null(info);
+  *info = (ancs_noti_info_t){.uid = uid++};
+  snprintf(info->app, sizeof(info->app), "%s", app);
+  snprintf(info->title, sizeof(info->title), "%s", title);
+
+  app_event_t event = {
+      .type = APP_EVENT_BLE_ANCS,
+      .ptr = info,
+      .len = sizeof(*info),
+  };
+  zassert_ok(event_post(&event));
+}
+
+static void scene_begin(void) { ui_cost_now(&mark); }
+
+/* Most refreshes that sent any one line of [y1, y2] since @p before */
+static uint32_t band_sends_since(const uint32_t* before, int16_t y1, int16_t y2) {
+  uint32_t most = 0;
+
+  for (int16_t y = y1; y <= y2; y++) {
+    most = MAX(most, fake_lcd_row_sends(y) - before[y - y1]);
+  }
+  return most;
+}
+
+static void scene_check(enum ui_scene scene) {
+  struct ui_cost end;
+  struct ui_cost cost;
+  uint32_t crc = crc32_ieee(fake_lcd_frame(), LCD_FRAME_BYTES);
+
+  ui_cost_now(&end);
+  cost.refreshes = end.refreshes - mark.refreshes;
+  cost.rows = end.rows - mark.rows;
+  cost.bytes = end.bytes - mark.bytes;
+  cost.spi_us = end.spi_us - mark.spi_us;
+  cost.pixels = end.pixels - mark.pixels;
+
+  printf("scene %-12s crc 0x%08x refreshes %u rows %u bytes %u spi %u us pixels %u\n", scene_names[scene], crc,
+         cost.refreshes, cost.rows, cost.bytes, cost.spi_us, cost.pixels);
+
+  zassert_true(cost.refreshes <= budgets[scene].refreshes, "%s: %u refreshes over budget %u", scene_names[scene],
+               cost.refreshes, budgets[scene].refreshes);
+  zassert_true(cost.rows <= budgets[scene].rows, "%s: %u rows over budget %u", scene_names[scene], cost.rows,
+               budgets[scene].rows);
+  zassert_true(cost.bytes <= budgets[scene].rows * LCD_LINE_XFER_BYTES, "%s: %u SPI bytes over budget",
+               scene_names[scene], cost.bytes);
+  zassert_true(cost.spi_us <= budgets[scene].rows * FAKE_LCD_LINE_US, "%s: %u us SPI over budget",
+               scene_names[scene], cost.spi_us);
+  zassert_true(cost.pixels <= budgets[scene].pixels, "%s: %u pixels rendered over budget %u", scene_names[scene],
+               cost.pixels, budgets[scene].pixels);
+
+  if (IS_ENABLED(CONFIG_UI_TEST_RECORD)) {
+    printf("scene %-12s record 0x%08x\n", scene_names[scene], crc);
+    return;
+  }
+  zassert_not_equal(golden_crc[scene], 0, "%s: no golden frame, record src/golden.h with CONFIG_UI_TEST_RECORD=y",
+                    scene_names[scene]);
+  zassert_equal(crc, golden_crc[scene], "%s: frame 0x%08x differs from golden 0x%08x", scene_names[scene], crc,
+                golden_crc[scene]);
+}
+
+ZTEST(app_ui, test_01_boot) {
+  scene_begin();
+  zassert_ok(app_init());
+  lv_display_add_event_cb(lv_display_get_default(), ui_count_flushed, LV_EVENT_FLUSH_START, NULL);
+  ui_settle();
+  scene_check(SCENE_BOOT);
+}
+
+ZTEST(app_ui, test_02_minute_tick) {
+  now.tm_min++;
+  fake_rtc_set(&now);
+
+  scene_begin();
+  ui_post(APP_EVENT_RTC_ALARM, 0);
+  ui_settle();
+  scene_check(SCENE_MINUTE_TICK);
+}
+
+ZTEST(app_ui, test_03_battery) {
+  scene_begin();
+  ui_post(APP_EVENT_BATTERY, 62);
+  ui_settle();
+  scene_check(SCENE_BATTERY);
+}
+
+ZTEST(app_ui, test_04_ancs_burst) {
+  static const char* const titles[BURST_SIZE] = {
+      "Lunch at 12?", "Build passed", "Tin nhắn mới", "Meeting moved", "Package delivered",
+  };
+  uint32_t toast_sends[BAND(TOAST_Y1, TOAST_Y2)];
+
+  for (int16_t y = TOAST_Y1; y <= TOAST_Y2; y++) {
+    toast_sends[y - TOAST_Y1] = fake_lcd_row_sends(y);
+  }
+  scene_begin();
+  for (int i = 0; i < BURST_SIZE; i++) {
+    ui_post_notification("Messages", titles[i]);
+    ui_settle();
+    k_sleep(K_MSEC(BURST_GAP_MS));
+  }
+  // The client reports the end of the burst once its queue has drained
+  ui_post(APP_EVENT_BLE_ANCS_IDLE, 0);
+  ui_settle();
+  scene_check(SCENE_ANCS_BURST);
+
+  zassert_equal(band_sends_since(toast_sends, TOAST_Y1, TOAST_Y2), 1, "burst should draw the toast once");
+}
+
+ZTEST(app_ui, test_05_toast_hidden) {
+  scene_begin();
+  k_sleep(K_MSEC(3100));
+  ui_settle();
+  scene_check(SCENE_TOAST_HIDDEN);
+}
+
+ZTEST(app_ui, test_06_noti_list) {
+  scene_begin();
+  ui_post(APP_EVENT_BUTTON, 1);
+  ui_settle();
+  scene_check(SCENE_NOTI_LIST);
+}
+
+ZTEST(app_ui, test_07_back_to_face) {
+  scene_begin();
+  ui_post(APP_EVENT_BUTTON, 3);
+  ui_settle();
+  scene_check(SCENE_BACK_TO_FACE);
+}
+
+static void* app_ui_setup(void) {
+  fake_rtc_set(&now);
+  return NULL;
+}
+
+ZTEST_SUITE(app_ui, NULL, app_ui_setup, NULL, NULL, NULL);